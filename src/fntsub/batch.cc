@@ -0,0 +1,168 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fntsub/batch.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <fstream>
+#include <utility>
+
+#include "fntsub/charset.h"
+#include "fntsub/subset.h"
+#include "fntsub/worker_pool.h"
+
+namespace fntsub {
+using namespace sfntly;
+using subtly::CodepointSet;
+
+namespace {
+
+const char kFilePrefix[] = "file:";
+const char kCodepointsPrefix[] = "codepoints:";
+
+bool HasPrefix(const std::string& text, const char* prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+Batch::Batch(int32_t num_workers)
+    : num_workers_(num_workers) {
+}
+
+bool Batch::LoadManifest(const char* manifest_path, std::string* error) {
+  std::ifstream manifest(manifest_path, std::ios::binary);
+  if (!manifest.is_open()) {
+    *error = std::string("cannot open ") + manifest_path;
+    return false;
+  }
+  std::string line;
+  int32_t line_number = 0;
+  while (std::getline(manifest, line)) {
+    ++line_number;
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (line.empty() || line[0] == '#')
+      continue;
+    BatchJob job;
+    job.line = line_number;
+    size_t first_tab = line.find('\t');
+    size_t second_tab = first_tab == std::string::npos ?
+        std::string::npos : line.find('\t', first_tab + 1);
+    if (second_tab == std::string::npos ||
+        line.find('\t', second_tab + 1) != std::string::npos) {
+      job.error = "expected three fields";
+    } else {
+      job.font_path = line.substr(0, first_tab);
+      job.characters = line.substr(first_tab + 1, second_tab - first_tab - 1);
+      job.output_path = line.substr(second_tab + 1);
+    }
+    jobs_.push_back(job);
+  }
+  return true;
+}
+
+int32_t Batch::Run(FILE* report) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  WorkerPool pool(num_workers_, (size_t)num_workers_ * 4);
+
+  // Load every font before the jobs start; the fonts are shared between
+  // workers.
+  for (size_t i = 0; i < jobs_.size(); ++i) {
+    if (jobs_[i].error.empty())
+      fonts_[jobs_[i].font_path] = NULL;
+  }
+  for (PreparedFontMap::iterator it = fonts_.begin(), e = fonts_.end();
+       it != e; ++it) {
+    Ptr<subtly::PreparedFont>* prepared_font = &it->second;
+    const char* font_path = it->first.c_str();
+    pool.Submit([prepared_font, font_path]() {
+      prepared_font->Attach(PrepareFontFile(font_path));
+    });
+  }
+  pool.Wait();
+
+  std::vector<BatchResult> results(jobs_.size());
+  for (size_t i = 0; i < jobs_.size(); ++i) {
+    const BatchJob* job = &jobs_[i];
+    BatchResult* result = &results[i];
+    pool.Submit([this, job, result]() { RunJob(*job, result); });
+  }
+  pool.Wait();
+
+  int32_t failed = 0;
+  fprintf(report, "# line\tstatus\tms\tbytes\toutput\tmessage\n");
+  for (size_t i = 0; i < jobs_.size(); ++i) {
+    const BatchResult& result = results[i];
+    if (!result.ok)
+      ++failed;
+    fprintf(report, "%d\t%s\t%.3f\t%lld\t%s\t%s\n", jobs_[i].line,
+            result.ok ? "ok" : "failed", result.milliseconds,
+            (long long)result.output_bytes, jobs_[i].output_path.c_str(),
+            result.message.c_str());
+  }
+  fprintf(report, "# jobs %d ok %d failed %d fonts %d workers %d ms %.3f\n",
+          (int32_t)jobs_.size(), (int32_t)jobs_.size() - failed, failed,
+          (int32_t)fonts_.size(), pool.num_workers(),
+          MillisecondsSince(start));
+  return failed;
+}
+
+void Batch::RunJob(const BatchJob& job, BatchResult* result) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  result->ok = false;
+  // Only looked up; the map was filled before the jobs started.
+  PreparedFontMap::const_iterator font = fonts_.find(job.font_path);
+  subtly::PreparedFont* prepared_font =
+      font == fonts_.end() ? NULL : font->second.p_;
+  CodepointSet characters;
+  if (!job.error.empty()) {
+    result->message = job.error;
+  } else if (!prepared_font) {
+    result->message = "cannot load font";
+  } else if (HasPrefix(job.characters, kFilePrefix)) {
+    std::string path = job.characters.substr(strlen(kFilePrefix));
+    result->ok = ReadTextFile(path.c_str(), &characters, &result->message);
+  } else if (HasPrefix(job.characters, kCodepointsPrefix)) {
+    result->ok = characters.AddRanges(
+        job.characters.substr(strlen(kCodepointsPrefix)));
+    if (!result->ok)
+      result->message = "malformed code point list";
+  } else {
+    result->message = "characters must start with file: or codepoints:";
+  }
+
+  if (result->ok) {
+    result->ok = SubsetPrepared(prepared_font, std::move(characters), false,
+                                job.output_path.c_str(), &result->message);
+  }
+  if (result->ok) {
+    struct stat output_stat;
+    if (stat(job.output_path.c_str(), &output_stat) == 0)
+      result->output_bytes = output_stat.st_size;
+  }
+  result->milliseconds = MillisecondsSince(start);
+}
+}
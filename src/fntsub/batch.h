@@ -0,0 +1,84 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FNTSUB_BATCH_H_
+#define FNTSUB_BATCH_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "subtly/prepared_font.h"
+
+namespace fntsub {
+// One subset to make. In the manifest a job is a line of three tab separated
+// fields:
+//   <font path> <characters> <output path>
+// where <characters> is "file:<path>" for a UTF-8 text file or
+// "codepoints:<list>" for Unicode ranges as CodepointSet::AddRanges accepts.
+// Empty lines and lines starting with '#' are skipped. A malformed line is
+// kept as a job that fails with |error|.
+struct BatchJob {
+  int32_t line;
+  std::string font_path;
+  std::string characters;
+  std::string output_path;
+  std::string error;
+};
+
+struct BatchResult {
+  BatchResult() : ok(false), milliseconds(0), output_bytes(0) {}
+
+  bool ok;
+  double milliseconds;
+  int64_t output_bytes;
+  std::string message;
+};
+
+// Runs the jobs of a manifest on a pool of workers. Every font is loaded and
+// prepared once, however many jobs use it, and a job that fails is reported
+// without stopping the others.
+class Batch {
+ public:
+  explicit Batch(int32_t num_workers);
+
+  // Reads the jobs of a manifest; malformed lines are reported by Run().
+  // @param error set to the reason on failure
+  // @return false if the manifest cannot be read
+  bool LoadManifest(const char* manifest_path, std::string* error);
+
+  // Runs the jobs and writes a tab separated report line per job, in
+  // manifest order, followed by a summary.
+  // @return the number of jobs that failed
+  int32_t Run(FILE* report);
+
+  const std::vector<BatchJob>& jobs() const { return jobs_; }
+
+ private:
+  typedef std::map<std::string, sfntly::Ptr<subtly::PreparedFont> >
+      PreparedFontMap;
+
+  void RunJob(const BatchJob& job, BatchResult* result);
+
+  int32_t num_workers_;
+  std::vector<BatchJob> jobs_;
+  PreparedFontMap fonts_;
+};
+}
+
+#endif  // FNTSUB_BATCH_H_
@@ -0,0 +1,54 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fntsub/charset.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+namespace fntsub {
+using namespace subtly;
+
+bool ReadTextFile(const char* path, CodepointSet* characters,
+                  std::string* error) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    *error = std::string("cannot open ") + path + ": " + strerror(errno);
+    return false;
+  }
+  std::vector<uint8_t> text;
+  uint8_t buffer[64 * 1024];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    for (size_t i = 0; i < count; ++i) {
+      if (buffer[i] != '\n')
+        text.push_back(buffer[i]);
+    }
+  }
+  bool read_error = ferror(file) != 0;
+  fclose(file);
+  if (read_error) {
+    *error = std::string("cannot read ") + path;
+    return false;
+  }
+  if (!text.empty() && !characters->AddUtf8(&text[0], text.size())) {
+    *error = std::string(path) + " is not valid UTF-8";
+    return false;
+  }
+  return true;
+}
+}
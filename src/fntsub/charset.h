@@ -0,0 +1,31 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FNTSUB_CHARSET_H_
+#define FNTSUB_CHARSET_H_
+
+#include <string>
+
+#include "subtly/codepoint_set.h"
+
+namespace fntsub {
+// Reads a UTF-8 text file; line breaks are not part of the text, as for the
+// -f option of the command line.
+// @param error set to the reason on failure
+// @return false if the file cannot be read or is not UTF-8
+bool ReadTextFile(const char* path, subtly::CodepointSet* characters,
+                  std::string* error);
+}
+
+#endif  // FNTSUB_CHARSET_H_
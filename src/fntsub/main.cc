@@ -4,16 +4,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include <locale>
-#include <codecvt>
 #include <string>
 #include <map>
 #include <utility>
 #include <fstream>
 #include <cstring>
+#include <thread>
 
+#include "fntsub/batch.h"
+#include "fntsub/charset.h"
+#include "fntsub/server.h"
+#include "fntsub/subset.h"
 #include "sfntly/font.h"
-#include "subtly/character_predicate.h"
+#include "subtly/codepoint_set.h"
 #include "subtly/stats.h"
 #include "subtly/subsetter.h"
 #include "subtly/utils.h"
@@ -22,15 +25,22 @@ using namespace subtly;
 
 void PrintUsage(const char* program_name) {
     fprintf(stdout, "Usage:\n\t%s <input_font_file> <output_dir_path>"
-                    " [-s <string>|-f <path>]\n", program_name);
-    fprintf(stdout, "\n\tAt least on of -s or -f must be specified.\n");
-}
-
-std::wstring StringToWstring(const char* utf8Bytes)
-{
-    using convert_type = std::codecvt_utf8<typename std::wstring::value_type >;
-    std::wstring_convert<convert_type, typename std::wstring::value_type> converter;
-    return converter.from_bytes(utf8Bytes);
+                    " [-s <string>|-f <path>|-u <unicode_ranges>] [-g]\n",
+                    program_name);
+    fprintf(stdout, "\t%s serve [-S <socket_path>] [-w <workers>]"
+                    " [-q <queued_requests>] [-c <connections>]"
+                    " <input_font_file>...\n", program_name);
+    fprintf(stdout, "\t%s batch [-w <workers>] [-r <report_path>]"
+                    " <manifest_path>\n", program_name);
+    fprintf(stdout, "\n\tAt least on of -s, -f or -u must be specified;"
+                    " -u takes ranges such as U+0020-007E,U+4E00.\n");
+    fprintf(stdout, "\t-g keeps the original glyph ids; glyphs not in the"
+                    " subset are left empty.\n");
+    fprintf(stdout, "\tserve answers subset requests on the socket, or on"
+                    " stdin/stdout without -S;\n\tfonts are addressed by"
+                    " their position on the command line.\n");
+    fprintf(stdout, "\tbatch runs the jobs of a manifest, one per line:"
+                    " <font>\\t<file:path|codepoints:list>\\t<output>.\n");
 }
 
 //根据路径获取文件名
@@ -64,10 +74,19 @@ std::vector<std::string> GetAllFontPath(const std::string &allPath) {
     return result;
 }
 
-int Subset(const char* font_path, const char* output_dir, const std::wstring &wstr);
+int Subset(const char* font_path, const char* output_dir,
+           const CodepointSet &characters, bool retain_glyph_ids);
+int Serve(const char* program_name, int argc, const char* argv[]);
+int RunBatch(const char* program_name, int argc, const char* argv[]);
 
 int main(int argc, const char* argv[]) {
     const char* program_name = argv[0];
+    if (argc >= 2 && std::strcmp(argv[1], "serve") == 0) {
+        return Serve(program_name, argc - 2, argv + 2);
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "batch") == 0) {
+        return RunBatch(program_name, argc - 2, argv + 2);
+    }
     if (argc < 5) {
         PrintUsage(program_name);
         exit(1);
@@ -75,34 +94,43 @@ int main(int argc, const char* argv[]) {
 
     clock_t start,end;
     start = clock();
-    std::wstring wstr;
+    CodepointSet characters;
     if (std::strcmp(argv[3], "-s") == 0) {
-        wstr = StringToWstring(argv[4]);
+        if (!characters.AddUtf8((const uint8_t*)argv[4], strlen(argv[4]))) {
+            fprintf(stderr, "-s text is not valid UTF-8.\n");
+            exit(1);
+        }
     } else if (std::strcmp(argv[3], "-f") == 0) {
-        std::ifstream fileStream(argv[4], std::ios::binary);
-        std::string text_content;
-        if (!fileStream.is_open()) {
-            fprintf(stderr, "failed to open %s", argv[4]);
+        std::string error;
+        if (!fntsub::ReadTextFile(argv[4], &characters, &error)) {
+            fprintf(stderr, "%s\n", error.c_str());
             exit(1);
         }
-
-        std::string line;
-        while (std::getline(fileStream, line)) {
-            text_content.append(line);
+    } else if (std::strcmp(argv[3], "-u") == 0) {
+        if (!characters.AddRanges(argv[4])) {
+            fprintf(stderr, "Malformed unicode ranges %s.\n", argv[4]);
+            exit(1);
         }
-        fileStream.close();
-        wstr = StringToWstring(text_content.c_str());
     } else {
         PrintUsage(program_name);
         exit(1);
     }
+    bool retain_glyph_ids = false;
+    for (int i = 5; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-g") == 0) {
+            retain_glyph_ids = true;
+        } else {
+            PrintUsage(program_name);
+            exit(1);
+        }
+    }
 
     const char* input_font_paths = argv[1];
     const char* output_font_path = argv[2];
     std::vector<std::string> allPath = GetAllFontPath(input_font_paths);
 
     for (const auto &path : allPath) {
-        Subset(path.data(), output_font_path, wstr);
+        Subset(path.data(), output_font_path, characters, retain_glyph_ids);
     }
     end = clock();
     printf("转换耗时 %.2f 毫秒", (end - start)/(double)CLOCKS_PER_SEC*1000);
@@ -110,34 +138,90 @@ int main(int argc, const char* argv[]) {
     return 0;
 }
 
-int Subset(const char* font_path, const char* output_dir, const std::wstring &wstr) {
-    FontPtr font;
-    font.Attach(subtly::LoadFont(font_path));
-    if (font->num_tables() == 0) {
-        fprintf(stderr, "Could not load font %s.\n", font_path);
-        exit(1);
+int Serve(const char* program_name, int argc, const char* argv[]) {
+    fntsub::ServerOptions options;
+    std::vector<std::string> font_paths;
+    for (int i = 0; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "-S") == 0 && has_value) {
+            options.socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "-w") == 0 && has_value) {
+            options.num_workers = atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-q") == 0 && has_value) {
+            options.max_queued_requests = atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-c") == 0 && has_value) {
+            options.max_connections = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            PrintUsage(program_name);
+            return 1;
+        } else {
+            std::vector<std::string> paths = GetAllFontPath(argv[i]);
+            font_paths.insert(font_paths.end(), paths.begin(), paths.end());
+        }
+    }
+    if (font_paths.empty()) {
+        PrintUsage(program_name);
+        return 1;
     }
 
-    auto charaters = new std::set<int32_t >;
-    for (const auto &unicode : wstr) {
-        charaters->insert((int32_t)unicode);
+    fntsub::Server server(options);
+    for (const auto &path : font_paths) {
+        if (!server.AddFont(path.data())) {
+            fprintf(stderr, "Could not load font %s.\n", path.data());
+            return 1;
+        }
     }
+    return server.Run();
+}
 
-    Ptr<CharacterPredicate> set_predicate =
-            new AcceptSet(charaters);
-    Ptr<Subsetter> subsetter = new Subsetter(font, set_predicate);
-    Ptr<Font> new_font;
-    new_font.Attach(subsetter->Subset());
-    if (!new_font) {
-        fprintf(stderr, "Cannot create subset.\n");
-        exit(1);
+int RunBatch(const char* program_name, int argc, const char* argv[]) {
+    int32_t num_workers = (int32_t)std::thread::hardware_concurrency();
+    const char* report_path = NULL;
+    const char* manifest_path = NULL;
+    for (int i = 0; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "-w") == 0 && has_value) {
+            num_workers = atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-r") == 0 && has_value) {
+            report_path = argv[++i];
+        } else if (argv[i][0] != '-' && !manifest_path) {
+            manifest_path = argv[i];
+        } else {
+            PrintUsage(program_name);
+            return 1;
+        }
     }
+    if (!manifest_path) {
+        PrintUsage(program_name);
+        return 1;
+    }
+
+    fntsub::Batch batch(num_workers);
+    std::string error;
+    if (!batch.LoadManifest(manifest_path, &error)) {
+        fprintf(stderr, "%s: %s\n", manifest_path, error.c_str());
+        return 1;
+    }
+    FILE* report = stdout;
+    if (report_path && !(report = fopen(report_path, "w"))) {
+        fprintf(stderr, "Cannot create report %s.\n", report_path);
+        return 1;
+    }
+    int32_t failed = batch.Run(report);
+    if (report != stdout)
+        fclose(report);
+    return failed == 0 ? 0 : 1;
+}
 
+int Subset(const char* font_path, const char* output_dir,
+           const CodepointSet &characters, bool retain_glyph_ids) {
     auto file_name = GetPathOrURLShortName(font_path);
     auto output_path = output_dir + std::string("/") + file_name;
-    bool success = subtly::SerializeFont(output_path.data(), new_font);
-    if (!success) {
-        fprintf(stderr, "Cannot create font file.\n");
+    std::string error;
+    if (!fntsub::SubsetFontFile(font_path, CodepointSet(characters),
+                                retain_glyph_ids, output_path.data(),
+                                &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
         exit(1);
     }
     return 0;
@@ -0,0 +1,462 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fntsub/server.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "fntsub/charset.h"
+#include "fntsub/subset.h"
+
+namespace fntsub {
+using namespace sfntly;
+using subtly::CodepointSet;
+
+namespace {
+
+bool ReadFully(int fd, uint8_t* buffer, size_t length) {
+  while (length > 0) {
+    ssize_t count = read(fd, buffer, length);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+    buffer += count;
+    length -= (size_t)count;
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const uint8_t* buffer, size_t length) {
+  while (length > 0) {
+    ssize_t count = write(fd, buffer, length);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+    buffer += count;
+    length -= (size_t)count;
+  }
+  return true;
+}
+
+uint32_t ReadUInt32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void WriteUInt32(uint32_t value, uint8_t* p) {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)(value >> 16);
+  p[2] = (uint8_t)(value >> 8);
+  p[3] = (uint8_t)value;
+}
+
+void SetMessage(const char* message, std::vector<uint8_t>* output) {
+  output->assign(message, message + strlen(message));
+}
+
+}  // namespace
+
+/******************************************************************************
+ * Server::Connection class
+ ******************************************************************************/
+// One client: the descriptors requests are read from and replies written to.
+// Workers write replies concurrently, each reply as one frame.
+class Server::Connection : public RefCounted<Server::Connection> {
+ public:
+  Connection(int in_fd, int out_fd, bool owns_fds)
+      : in_fd_(in_fd), out_fd_(out_fd), owns_fds_(owns_fds) {
+  }
+  ~Connection() {
+    if (owns_fds_) {
+      close(in_fd_);
+      if (out_fd_ != in_fd_)
+        close(out_fd_);
+    }
+  }
+
+  // @param too_large set if the frame was refused for its size
+  // @return false at the end of the input, on a read error or for a frame
+  //         that is too large
+  bool ReadFrame(std::vector<uint8_t>* frame, bool* too_large) {
+    *too_large = false;
+    uint8_t length_bytes[4];
+    if (!ReadFully(in_fd_, length_bytes, sizeof(length_bytes)))
+      return false;
+    uint32_t length = ReadUInt32(length_bytes);
+    if (length > (uint32_t)Protocol::kMaxFrameSize) {
+      *too_large = true;
+      return false;
+    }
+    frame->resize(length);
+    return length == 0 || ReadFully(in_fd_, &(*frame)[0], length);
+  }
+
+  // @return the size of the frame written; 0 if the client is gone
+  size_t WriteReply(uint32_t request_id, int32_t status,
+                    const std::vector<uint8_t>& body) {
+    uint8_t header[4 + Protocol::kReplyHeaderSize];
+    WriteUInt32((uint32_t)(Protocol::kReplyHeaderSize + body.size()), header);
+    WriteUInt32(request_id, header + 4);
+    header[8] = (uint8_t)status;
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!WriteFully(out_fd_, header, sizeof(header)) ||
+        (!body.empty() && !WriteFully(out_fd_, &body[0], body.size()))) {
+      return 0;
+    }
+    return sizeof(header) + body.size();
+  }
+
+  // Makes a blocked ReadFrame return.
+  void Shutdown() { shutdown(in_fd_, SHUT_RDWR); }
+
+ private:
+  int in_fd_;
+  int out_fd_;
+  bool owns_fds_;
+  std::mutex write_mutex_;
+};
+
+/******************************************************************************
+ * ServerStats class
+ ******************************************************************************/
+ServerStats::ServerStats()
+    : start_time_(std::chrono::steady_clock::now()),
+      requests_(0),
+      errors_(0),
+      request_bytes_(0),
+      reply_bytes_(0),
+      total_latency_us_(0),
+      max_latency_us_(0) {
+  for (int32_t i = 0; i < kNumBuckets; ++i) {
+    latency_buckets_[i].store(0);
+  }
+}
+
+void ServerStats::Record(int32_t status, int64_t latency_us,
+                         size_t request_bytes, size_t reply_bytes) {
+  requests_.fetch_add(1, std::memory_order_relaxed);
+  if (status != Protocol::kOk)
+    errors_.fetch_add(1, std::memory_order_relaxed);
+  request_bytes_.fetch_add((int64_t)request_bytes, std::memory_order_relaxed);
+  reply_bytes_.fetch_add((int64_t)reply_bytes, std::memory_order_relaxed);
+  total_latency_us_.fetch_add(latency_us, std::memory_order_relaxed);
+  int64_t max_latency = max_latency_us_.load(std::memory_order_relaxed);
+  while (latency_us > max_latency &&
+         !max_latency_us_.compare_exchange_weak(max_latency, latency_us,
+                                                std::memory_order_relaxed)) {
+  }
+  int32_t bucket = 0;
+  while (bucket < kNumBuckets - 1 && (latency_us >> (bucket + 1)) > 0) {
+    ++bucket;
+  }
+  latency_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t ServerStats::Percentile(double fraction) const {
+  int64_t total = 0;
+  for (int32_t i = 0; i < kNumBuckets; ++i) {
+    total += latency_buckets_[i].load(std::memory_order_relaxed);
+  }
+  if (total == 0)
+    return 0;
+  int64_t rank = (int64_t)(fraction * total);
+  if (rank < 1)
+    rank = 1;
+  int64_t seen = 0;
+  for (int32_t i = 0; i < kNumBuckets; ++i) {
+    seen += latency_buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return (int64_t)1 << (i + 1);
+  }
+  return (int64_t)1 << kNumBuckets;
+}
+
+std::string ServerStats::Dump() const {
+  double uptime = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start_time_).count();
+  int64_t requests = requests_.load(std::memory_order_relaxed);
+  char line[128];
+  std::string dump;
+  snprintf(line, sizeof(line), "uptime_s %.3f\n", uptime);
+  dump += line;
+  snprintf(line, sizeof(line), "requests %lld\n", (long long)requests);
+  dump += line;
+  snprintf(line, sizeof(line), "errors %lld\n",
+           (long long)errors_.load(std::memory_order_relaxed));
+  dump += line;
+  snprintf(line, sizeof(line), "requests_per_s %.2f\n",
+           uptime > 0 ? requests / uptime : 0.0);
+  dump += line;
+  snprintf(line, sizeof(line), "request_bytes %lld\n",
+           (long long)request_bytes_.load(std::memory_order_relaxed));
+  dump += line;
+  snprintf(line, sizeof(line), "reply_bytes %lld\n",
+           (long long)reply_bytes_.load(std::memory_order_relaxed));
+  dump += line;
+  snprintf(line, sizeof(line), "latency_mean_us %lld\n",
+           (long long)(requests > 0 ?
+               total_latency_us_.load(std::memory_order_relaxed) / requests :
+               0));
+  dump += line;
+  snprintf(line, sizeof(line), "latency_p50_us %lld\n",
+           (long long)Percentile(0.50));
+  dump += line;
+  snprintf(line, sizeof(line), "latency_p90_us %lld\n",
+           (long long)Percentile(0.90));
+  dump += line;
+  snprintf(line, sizeof(line), "latency_p99_us %lld\n",
+           (long long)Percentile(0.99));
+  dump += line;
+  snprintf(line, sizeof(line), "latency_max_us %lld\n",
+           (long long)max_latency_us_.load(std::memory_order_relaxed));
+  dump += line;
+  // The histogram, by the upper bound of each non-empty bucket.
+  for (int32_t i = 0; i < kNumBuckets; ++i) {
+    int64_t count = latency_buckets_[i].load(std::memory_order_relaxed);
+    if (count == 0)
+      continue;
+    snprintf(line, sizeof(line), "latency_lt_%lld_us %lld\n",
+             (long long)((int64_t)1 << (i + 1)), (long long)count);
+    dump += line;
+  }
+  return dump;
+}
+
+/******************************************************************************
+ * Server class
+ ******************************************************************************/
+ServerOptions::ServerOptions()
+    : num_workers(4),
+      max_queued_requests(64),
+      max_connections(64) {
+}
+
+Server::Server(const ServerOptions& options)
+    : options_(options),
+      pool_(options.num_workers, (size_t)options.max_queued_requests) {
+}
+
+Server::~Server() {
+  pool_.Shutdown();
+}
+
+bool Server::AddFont(const char* font_path) {
+  // Fonts are shared by all workers.
+  Ptr<subtly::PreparedFont> prepared_font;
+  prepared_font.Attach(PrepareFontFile(font_path));
+  if (!prepared_font)
+    return false;
+  fonts_.push_back(prepared_font);
+  return true;
+}
+
+int Server::Run() {
+  // A client that goes away must not take the server with it.
+  signal(SIGPIPE, SIG_IGN);
+  return options_.socket_path.empty() ? RunStdio() : RunSocket();
+}
+
+int Server::RunStdio() {
+  ConnectionPtr connection = new Connection(STDIN_FILENO, STDOUT_FILENO,
+                                            false);
+  ReadRequests(connection);
+  pool_.Wait();
+  fputs(stats_.Dump().c_str(), stderr);
+  return 0;
+}
+
+int Server::RunSocket() {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (options_.socket_path.size() >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path %s is too long.\n",
+            options_.socket_path.c_str());
+    return 1;
+  }
+  strncpy(address.sun_path, options_.socket_path.c_str(),
+          sizeof(address.sun_path) - 1);
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0) {
+    fprintf(stderr, "Cannot create socket: %s\n", strerror(errno));
+    return 1;
+  }
+  unlink(address.sun_path);
+  if (bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0) {
+    fprintf(stderr, "Cannot listen on %s: %s\n", address.sun_path,
+            strerror(errno));
+    close(listen_fd);
+    return 1;
+  }
+
+  int exit_code = 0;
+  for (;;) {
+    int client_fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (client_fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      fprintf(stderr, "Cannot accept connections: %s\n", strerror(errno));
+      exit_code = 1;
+      break;
+    }
+    ConnectionPtr connection = new Connection(client_fd, client_fd, true);
+    {
+      std::lock_guard<std::mutex> lock(connections_mutex_);
+      if ((int32_t)connections_.size() < options_.max_connections) {
+        connections_.insert(connection);
+        std::thread(&Server::ServeConnection, this, connection).detach();
+        continue;
+      }
+    }
+    std::vector<uint8_t> message;
+    SetMessage("too many connections", &message);
+    connection->WriteReply(0, Protocol::kBusy, message);
+  }
+  close(listen_fd);
+
+  // Stop the readers and let the requests they queued finish.
+  std::unique_lock<std::mutex> lock(connections_mutex_);
+  for (std::set<Connection*>::iterator it = connections_.begin(),
+           e = connections_.end(); it != e; ++it) {
+    (*it)->Shutdown();
+  }
+  while (!connections_.empty()) {
+    connections_closed_.wait(lock);
+  }
+  lock.unlock();
+  pool_.Wait();
+  fputs(stats_.Dump().c_str(), stderr);
+  return exit_code;
+}
+
+void Server::ServeConnection(ConnectionPtr connection) {
+  ReadRequests(connection);
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  connections_.erase(connection);
+  connections_closed_.notify_all();
+}
+
+void Server::ReadRequests(Connection* connection) {
+  ConnectionPtr connection_ptr = connection;
+  for (;;) {
+    std::shared_ptr<std::vector<uint8_t> > request(
+        new std::vector<uint8_t>);
+    bool too_large = false;
+    if (!connection->ReadFrame(request.get(), &too_large)) {
+      if (too_large) {
+        std::vector<uint8_t> message;
+        SetMessage("request too large", &message);
+        size_t reply_bytes =
+            connection->WriteReply(0, Protocol::kBadRequest, message);
+        stats_.Record(Protocol::kBadRequest, 0, 0, reply_bytes);
+      }
+      return;
+    }
+    if (!pool_.Submit([this, connection_ptr, request]() {
+          HandleRequest(connection_ptr.p_, request.get());
+        })) {
+      return;
+    }
+  }
+}
+
+void Server::HandleRequest(Connection* connection,
+                           std::vector<uint8_t>* request) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  uint32_t request_id = request->size() >= 4 ? ReadUInt32(&(*request)[0]) : 0;
+  std::vector<uint8_t> output;
+  int32_t status = Process(*request, &output);
+  size_t reply_bytes = connection->WriteReply(request_id, status, output);
+  int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  stats_.Record(status, latency_us, request->size() + 4, reply_bytes);
+}
+
+int32_t Server::Process(const std::vector<uint8_t>& request,
+                        std::vector<uint8_t>* output) {
+  if ((int32_t)request.size() < Protocol::kRequestHeaderSize) {
+    SetMessage("request too short", output);
+    return Protocol::kBadRequest;
+  }
+  int32_t command = request[4];
+  int32_t format = request[5];
+  int32_t font_id = (request[6] << 8) | request[7];
+  const uint8_t* body = &request[0] + Protocol::kRequestHeaderSize;
+  size_t body_length = request.size() - Protocol::kRequestHeaderSize;
+
+  if (command == Protocol::kStats) {
+    std::string dump = stats_.Dump();
+    output->assign(dump.begin(), dump.end());
+    return Protocol::kOk;
+  }
+  if (command != Protocol::kSubsetText &&
+      command != Protocol::kSubsetCodepoints) {
+    SetMessage("unknown command", output);
+    return Protocol::kBadRequest;
+  }
+  if (format != Protocol::kTrueType &&
+      format != Protocol::kTrueTypeRetainGlyphIds) {
+    SetMessage("unsupported output format", output);
+    return Protocol::kBadRequest;
+  }
+  if (font_id >= num_fonts()) {
+    SetMessage("unknown font", output);
+    return Protocol::kUnknownFont;
+  }
+
+  CodepointSet characters;
+  if (command == Protocol::kSubsetText) {
+    if (!characters.AddUtf8(body, body_length)) {
+      SetMessage("text is not valid UTF-8", output);
+      return Protocol::kBadRequest;
+    }
+  } else {
+    if (body_length % 4 != 0) {
+      SetMessage("code points are not a whole number of uint32", output);
+      return Protocol::kBadRequest;
+    }
+    for (size_t i = 0; i < body_length; i += 4) {
+      uint32_t character = ReadUInt32(body + i);
+      if (character > (uint32_t)CodepointSet::kMaxCodepoint) {
+        SetMessage("code point out of range", output);
+        return Protocol::kBadRequest;
+      }
+      characters.Add((int32_t)character);
+    }
+  }
+
+  std::string error;
+  if (!SubsetPrepared(fonts_[font_id], std::move(characters),
+                      format == Protocol::kTrueTypeRetainGlyphIds, &pool_,
+                      output, &error)) {
+    SetMessage(error.c_str(), output);
+    return Protocol::kSubsetFailed;
+  }
+  return Protocol::kOk;
+}
+}
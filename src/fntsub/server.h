@@ -0,0 +1,177 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FNTSUB_SERVER_H_
+#define FNTSUB_SERVER_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "subtly/prepared_font.h"
+#include "fntsub/worker_pool.h"
+
+namespace fntsub {
+// The request protocol spoken by `fntsub serve`, over a Unix domain socket or
+// stdin/stdout. Every message is a frame: a 32 bit big-endian payload length
+// followed by the payload. All integers are big-endian.
+//
+// Request payload:
+//   uint32 request_id   echoed in the reply
+//   uint8  command      one of Command
+//   uint8  format       one of OutputFormat
+//   uint16 font_id      index of the font on the serve command line
+//   ...                 kSubsetText: UTF-8 text
+//                       kSubsetCodepoints: uint32 code points
+//                       kStats: nothing
+// Reply payload:
+//   uint32 request_id
+//   uint8  status       one of Status
+//   ...                 kOk: the subset font, or the stats text
+//                       otherwise: an error message
+//
+// Requests on one connection may be answered out of order; the request id
+// tells the replies apart.
+struct Protocol {
+  enum Command {
+    kSubsetText = 1,
+    kSubsetCodepoints = 2,
+    kStats = 3
+  };
+  enum OutputFormat {
+    kTrueType = 0,
+    // TrueType keeping the source font's glyph ids; see
+    // FontAssembler::set_retain_glyph_ids.
+    kTrueTypeRetainGlyphIds = 1
+  };
+  enum Status {
+    kOk = 0,
+    kBadRequest = 1,
+    kUnknownFont = 2,
+    kSubsetFailed = 3,
+    kBusy = 4
+  };
+  static const int32_t kRequestHeaderSize = 8;
+  static const int32_t kReplyHeaderSize = 5;
+  // Frames larger than this are refused and the connection is closed.
+  static const int32_t kMaxFrameSize = 64 * 1024 * 1024;
+};
+
+// Request counters and a latency histogram, updated by the workers without
+// locking.
+class ServerStats {
+ public:
+  ServerStats();
+
+  void Record(int32_t status, int64_t latency_us, size_t request_bytes,
+              size_t reply_bytes);
+
+  // @return the counters, throughput and latency percentiles as text, one
+  //         "name value" pair per line
+  std::string Dump() const;
+
+ private:
+  // Bucket i counts latencies in [2^i, 2^(i+1)) microseconds.
+  static const int32_t kNumBuckets = 32;
+
+  // @return the upper bound in microseconds of the bucket holding the given
+  //         fraction of the requests
+  int64_t Percentile(double fraction) const;
+
+  std::chrono::steady_clock::time_point start_time_;
+  std::atomic<int64_t> requests_;
+  std::atomic<int64_t> errors_;
+  std::atomic<int64_t> request_bytes_;
+  std::atomic<int64_t> reply_bytes_;
+  std::atomic<int64_t> total_latency_us_;
+  std::atomic<int64_t> max_latency_us_;
+  std::atomic<int64_t> latency_buckets_[kNumBuckets];
+
+  NO_COPY_AND_ASSIGN(ServerStats);
+};
+
+struct ServerOptions {
+  ServerOptions();
+
+  // Listen on this Unix domain socket; serve stdin/stdout if empty.
+  std::string socket_path;
+  int32_t num_workers;
+  // Requests read but not yet being worked on.
+  int32_t max_queued_requests;
+  // Concurrent socket connections; further connections are refused with a
+  // kBusy reply.
+  int32_t max_connections;
+};
+
+// Keeps prepared fonts resident and answers subset requests for them on a
+// pool of workers.
+class Server {
+ public:
+  explicit Server(const ServerOptions& options);
+  ~Server();
+
+  // Loads and prepares a font; it is addressed by the number of fonts added
+  // before it.
+  // @return false if the font could not be loaded or is not subsettable
+  bool AddFont(const char* font_path);
+  int32_t num_fonts() const { return (int32_t)fonts_.size(); }
+
+  // Serves requests until stdin is closed or, for a socket, until accepting
+  // connections fails.
+  // @return the process exit code
+  int Run();
+
+  const ServerStats& stats() const { return stats_; }
+
+ private:
+  class Connection;
+  typedef sfntly::Ptr<Connection> ConnectionPtr;
+
+  int RunStdio();
+  int RunSocket();
+  // Reads requests from the connection and queues them until it is closed.
+  void ReadRequests(Connection* connection);
+  void ServeConnection(ConnectionPtr connection);
+  void HandleRequest(Connection* connection, std::vector<uint8_t>* request);
+  // @return the reply status; on kOk output holds the reply body, otherwise
+  //         the error message
+  int32_t Process(const std::vector<uint8_t>& request,
+                  std::vector<uint8_t>* output);
+
+  ServerOptions options_;
+  std::vector<sfntly::Ptr<subtly::PreparedFont> > fonts_;
+  ServerStats stats_;
+  // Runs the requests; workers without a request of their own help copy the
+  // tables of large replies.
+  WorkerPool pool_;
+
+  // Socket connections whose requests are still being read; closed when Run
+  // returns.
+  std::mutex connections_mutex_;
+  std::condition_variable connections_closed_;
+  std::set<Connection*> connections_;
+
+  NO_COPY_AND_ASSIGN(Server);
+};
+}
+
+#endif  // FNTSUB_SERVER_H_
@@ -0,0 +1,170 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fntsub/subset.h"
+
+#include <utility>
+
+#include "sfntly/font.h"
+#include "sfntly/font_factory.h"
+#include "sfntly/port/arena.h"
+#include "subtly/character_predicate.h"
+#include "subtly/subsetter.h"
+#include "subtly/utils.h"
+
+namespace fntsub {
+using namespace sfntly;
+using subtly::AcceptCodepoints;
+using subtly::CharacterPredicate;
+using subtly::CodepointSet;
+using subtly::PreparedFont;
+
+namespace {
+
+// Loads the first font in the file without the tables every subset drops.
+CALLER_ATTACH Font* LoadFontForSubset(const char* font_path) {
+  IntegerSet table_blacklist;
+  subtly::Subsetter::GetTableBlacklist(&table_blacklist);
+  FontPtr font;
+  font.Attach(subtly::LoadFont(font_path, &table_blacklist));
+  if (!font || font->num_tables() == 0)
+    return NULL;
+  return font.Detach();
+}
+
+// Cuts the subset from a font prepared for sharing.
+CALLER_ATTACH Font* CutPreparedFont(PreparedFont* prepared_font,
+                                    CharacterPredicate* predicate,
+                                    bool retain_glyph_ids,
+                                    std::string* error) {
+  Font* subset = subtly::Subset(prepared_font, predicate, retain_glyph_ids);
+  if (!subset)
+    *error = "cannot create subset";
+  return subset;
+}
+
+// Loads the font file, into the current arena, and cuts the subset from it.
+CALLER_ATTACH Font* CutFontFile(const char* font_path,
+                                CharacterPredicate* predicate,
+                                bool retain_glyph_ids,
+                                std::string* error) {
+  FontPtr font;
+  font.Attach(LoadFontForSubset(font_path));
+  if (!font) {
+    *error = std::string("cannot load font ") + font_path;
+    return NULL;
+  }
+  Ptr<subtly::Subsetter> subsetter = new subtly::Subsetter(font, predicate);
+  subsetter->set_retain_glyph_ids(retain_glyph_ids);
+  Font* subset = subsetter->Subset();
+  if (!subset)
+    *error = "cannot create subset";
+  return subset;
+}
+
+// Builds the subset with cut in a request-scoped arena and hands it to write,
+// which must be done with it before the arena goes away. cut sets error when
+// it returns NULL.
+template <typename Cutter, typename Writer>
+bool SubsetInArena(CodepointSet&& characters,
+                   const Cutter& cut,
+                   const Writer& write,
+                   const char* write_error,
+                   std::string* error) {
+  // Everything built for the subset lives in the arena and stays on this
+  // thread. A subset of a shared prepared font reads it through table
+  // builders of its own; see PreparedFont.
+  Arena arena;
+  ArenaScope arena_scope(&arena);
+  RefCountPolicyScope refcount_policy(RefCountPolicy::kThreadConfined);
+  Ptr<CharacterPredicate> predicate =
+      new AcceptCodepoints(std::move(characters));
+  FontPtr subset;
+  subset.Attach(cut(predicate, error));
+  if (!subset)
+    return false;
+  if (!write(subset)) {
+    *error = write_error;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+CALLER_ATTACH PreparedFont* PrepareFontFile(const char* font_path) {
+  FontPtr font;
+  font.Attach(LoadFontForSubset(font_path));
+  if (!font)
+    return NULL;
+  return PreparedFont::Prepare(font);
+}
+
+bool SubsetPrepared(PreparedFont* prepared_font,
+                    CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    TaskRunner* task_runner,
+                    std::vector<uint8_t>* output,
+                    std::string* error) {
+  return SubsetInArena(
+      std::move(characters),
+      [prepared_font, retain_glyph_ids](CharacterPredicate* predicate,
+                                        std::string* error) {
+        return CutPreparedFont(prepared_font, predicate, retain_glyph_ids,
+                               error);
+      },
+      [task_runner, output](Font* subset) {
+        FontFactoryPtr font_factory;
+        font_factory.Attach(FontFactory::GetInstance());
+        return subtly::SerializeFontToBuffer(output, font_factory, subset,
+                                             task_runner);
+      },
+      "cannot serialize subset", error);
+}
+
+bool SubsetPrepared(PreparedFont* prepared_font,
+                    CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    const char* output_path,
+                    std::string* error) {
+  return SubsetInArena(
+      std::move(characters),
+      [prepared_font, retain_glyph_ids](CharacterPredicate* predicate,
+                                        std::string* error) {
+        return CutPreparedFont(prepared_font, predicate, retain_glyph_ids,
+                               error);
+      },
+      [output_path](Font* subset) {
+        return subtly::SerializeFont(output_path, subset);
+      },
+      "cannot write subset", error);
+}
+
+bool SubsetFontFile(const char* font_path,
+                    CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    const char* output_path,
+                    std::string* error) {
+  return SubsetInArena(
+      std::move(characters),
+      [font_path, retain_glyph_ids](CharacterPredicate* predicate,
+                                    std::string* error) {
+        return CutFontFile(font_path, predicate, retain_glyph_ids, error);
+      },
+      [output_path](Font* subset) {
+        return subtly::SerializeFont(output_path, subset);
+      },
+      "cannot write subset", error);
+}
+}
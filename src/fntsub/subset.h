@@ -0,0 +1,67 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FNTSUB_SUBSET_H_
+#define FNTSUB_SUBSET_H_
+
+#include <string>
+#include <vector>
+
+#include "sfntly/port/task_runner.h"
+#include "sfntly/port/type.h"
+#include "subtly/codepoint_set.h"
+#include "subtly/prepared_font.h"
+
+namespace fntsub {
+// Loads the first font in the file, skipping the tables every subset drops,
+// and prepares it for subsetting. The font is loaded outside any arena and
+// keeps atomic reference counts, so the result may be shared between
+// threads.
+// @return NULL if the file holds no font or the font cannot be prepared
+CALLER_ATTACH subtly::PreparedFont* PrepareFontFile(const char* font_path);
+
+// Cuts the subset of the characters from the prepared font and serializes it
+// into output. Everything built for the subset lives in an arena of its own
+// with thread-confined reference counts, and is released before returning.
+// @param retain_glyph_ids keep the original glyph ids, see
+//        FontAssembler::set_retain_glyph_ids()
+// @param task_runner threads that may help copy the serialized tables; may
+//        be NULL
+// @param error set to the reason on failure
+// @return false if the subset cannot be created or serialized
+bool SubsetPrepared(subtly::PreparedFont* prepared_font,
+                    subtly::CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    sfntly::TaskRunner* task_runner,
+                    std::vector<uint8_t>* output,
+                    std::string* error);
+// As above, writing the subset to the file at output_path; missing
+// directories are created.
+bool SubsetPrepared(subtly::PreparedFont* prepared_font,
+                    subtly::CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    const char* output_path,
+                    std::string* error);
+
+// Subsets the first font in the file without preparing it first, which is
+// cheaper for a font that is subset once. The font is loaded into the
+// subset's arena. The subset is written to the file at output_path.
+bool SubsetFontFile(const char* font_path,
+                    subtly::CodepointSet&& characters,
+                    bool retain_glyph_ids,
+                    const char* output_path,
+                    std::string* error);
+}
+
+#endif  // FNTSUB_SUBSET_H_
@@ -0,0 +1,99 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fntsub/worker_pool.h"
+
+namespace fntsub {
+
+WorkerPool::WorkerPool(int32_t num_workers, size_t max_queued_tasks)
+    : max_queued_tasks_(max_queued_tasks > 0 ? max_queued_tasks : 1),
+      busy_workers_(0),
+      shutting_down_(false) {
+  if (num_workers < 1)
+    num_workers = 1;
+  for (int32_t i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::thread(&WorkerPool::Run, this));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  Shutdown();
+}
+
+bool WorkerPool::Submit(const Task& task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!shutting_down_ && tasks_.size() >= max_queued_tasks_) {
+    space_available_.wait(lock);
+  }
+  if (shutting_down_)
+    return false;
+  tasks_.push_back(task);
+  task_available_.notify_one();
+  return true;
+}
+
+bool WorkerPool::TryPostTask(const Task& task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shutting_down_ || tasks_.size() >= max_queued_tasks_)
+    return false;
+  tasks_.push_back(task);
+  task_available_.notify_one();
+  return true;
+}
+
+void WorkerPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!tasks_.empty() || busy_workers_ > 0) {
+    idle_.wait(lock);
+  }
+}
+
+void WorkerPool::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutting_down_ && workers_.empty())
+      return;
+    shutting_down_ = true;
+  }
+  task_available_.notify_all();
+  space_available_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i].join();
+  }
+  workers_.clear();
+}
+
+void WorkerPool::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    while (!shutting_down_ && tasks_.empty()) {
+      task_available_.wait(lock);
+    }
+    // Queued tasks still run after shutdown starts.
+    if (tasks_.empty())
+      return;
+    Task task;
+    task.swap(tasks_.front());
+    tasks_.pop_front();
+    ++busy_workers_;
+    space_available_.notify_one();
+    lock.unlock();
+    task();
+    lock.lock();
+    --busy_workers_;
+    if (tasks_.empty() && busy_workers_ == 0)
+      idle_.notify_all();
+  }
+}
+}
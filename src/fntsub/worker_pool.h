@@ -0,0 +1,78 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FNTSUB_WORKER_POOL_H_
+#define FNTSUB_WORKER_POOL_H_
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sfntly/port/task_runner.h"
+#include "sfntly/port/type.h"
+
+namespace fntsub {
+// A fixed number of threads running tasks from a bounded queue. Submit blocks
+// while the queue is full, so a producer reading requests faster than the
+// workers answer them is slowed down instead of queueing without limit.
+// As a TaskRunner it takes spare work from its own tasks while there is room
+// in the queue.
+class WorkerPool : public sfntly::TaskRunner {
+ public:
+  // @param num_workers the number of threads; at least one is started
+  // @param max_queued_tasks the number of tasks that may wait for a worker;
+  //        at least one
+  WorkerPool(int32_t num_workers, size_t max_queued_tasks);
+  // Runs the queued tasks and joins the workers.
+  ~WorkerPool();
+
+  // Queues a task, waiting for room in the queue if necessary.
+  // @return false if the pool is shutting down and the task was not queued
+  bool Submit(const Task& task);
+
+  // Queues a task if there is room in the queue.
+  // @return false if the queue is full or the pool is shutting down
+  virtual bool TryPostTask(const Task& task);
+
+  // Waits until every task submitted so far has run.
+  void Wait();
+
+  // Stops accepting tasks, runs the queued ones and joins the workers.
+  void Shutdown();
+
+  int32_t num_workers() const { return (int32_t)workers_.size(); }
+
+ private:
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable space_available_;
+  std::condition_variable idle_;
+  std::deque<Task> tasks_;
+  size_t max_queued_tasks_;
+  int32_t busy_workers_;
+  bool shutting_down_;
+  std::vector<std::thread> workers_;
+
+  NO_COPY_AND_ASSIGN(WorkerPool);
+};
+}
+
+#endif  // FNTSUB_WORKER_POOL_H_
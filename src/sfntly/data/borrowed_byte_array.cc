@@ -0,0 +1,94 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sfntly/data/borrowed_byte_array.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "sfntly/port/exception_type.h"
+
+namespace sfntly {
+
+BorrowedByteArray::BorrowedByteArray(const uint8_t* b, int32_t length)
+    : ByteArray(length, length), b_(b) {
+  assert(b);
+}
+
+BorrowedByteArray::~BorrowedByteArray() {
+  Close();
+}
+
+int32_t BorrowedByteArray::CopyTo(OutputStream* os,
+                                  int32_t offset,
+                                  int32_t length) {
+  assert(os);
+  if (offset < 0 || offset >= Length() || length <= 0)
+    return 0;
+  int32_t actual_length = std::min<int32_t>(length, Length() - offset);
+  os->Write(const_cast<uint8_t*>(b_), offset, actual_length);
+  return actual_length;
+}
+
+void BorrowedByteArray::InternalPut(int32_t index, uint8_t b) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+#if defined (SFNTLY_NO_EXCEPTION)
+  // Nothing else reports the dropped write.
+  assert(!read_only());
+#else
+  throw IOException("Attempt to write to a read-only borrowed array");
+#endif
+}
+
+int32_t BorrowedByteArray::InternalPut(int32_t index,
+                                       uint8_t* b,
+                                       int32_t offset,
+                                       int32_t length) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+#if defined (SFNTLY_NO_EXCEPTION)
+  // Nothing else reports the dropped write.
+  assert(!read_only());
+#else
+  throw IOException("Attempt to write to a read-only borrowed array");
+#endif
+  return 0;
+}
+
+uint8_t BorrowedByteArray::InternalGet(int32_t index) {
+  return b_[index];
+}
+
+int32_t BorrowedByteArray::InternalGet(int32_t index,
+                                       uint8_t* b,
+                                       int32_t offset,
+                                       int32_t length) {
+  assert(b);
+  memcpy(b + offset, b_ + index, length);
+  return length;
+}
+
+void BorrowedByteArray::Close() {
+  b_ = NULL;
+}
+
+uint8_t* BorrowedByteArray::Begin() {
+  return const_cast<uint8_t*>(b_);
+}
+
+}  // namespace sfntly
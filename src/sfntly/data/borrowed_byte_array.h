@@ -0,0 +1,76 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_BORROWED_BYTE_ARRAY_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_BORROWED_BYTE_ARRAY_H_
+
+#include "sfntly/data/byte_array.h"
+
+namespace sfntly {
+
+// A read-only ByteArray over memory owned by someone else, e.g. a buffer
+// handed in by an embedder or a region of a larger mapping. The caller must
+// keep the memory alive for as long as the array, and anything sliced from it,
+// is in use.
+// Writes are rejected: Put() on a BorrowedByteArray writes nothing, and
+// asserts in debug builds.
+class BorrowedByteArray : public ByteArray {
+ public:
+  // Construct a view over existing memory. The array does not take ownership
+  // of the memory and never frees it.
+  // @param b the memory to view
+  // @param length the number of bytes in the view
+  BorrowedByteArray(const uint8_t* b, int32_t length);
+  virtual ~BorrowedByteArray();
+
+  virtual bool read_only() const { return true; }
+
+  virtual int32_t CopyTo(OutputStream* os, int32_t offset, int32_t length);
+
+  // Make gcc -Woverloaded-virtual happy.
+  virtual int32_t CopyTo(ByteArray* array) { return ByteArray::CopyTo(array); }
+  virtual int32_t CopyTo(ByteArray* array, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(array, offset, length);
+  }
+  virtual int32_t CopyTo(int32_t dst_offset,
+                         ByteArray* array,
+                         int32_t src_offset,
+                         int32_t length) {
+    return ByteArray::CopyTo(dst_offset, array, src_offset, length);
+  }
+  virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
+
+ protected:
+  virtual void InternalPut(int32_t index, uint8_t b);
+  virtual int32_t InternalPut(int32_t index,
+                              uint8_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual uint8_t InternalGet(int32_t index);
+  virtual int32_t InternalGet(int32_t index,
+                              uint8_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual void Close();
+  virtual uint8_t* Begin();
+
+ private:
+  const uint8_t* b_;
+};
+typedef Ptr<BorrowedByteArray> BorrowedByteArrayPtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_BORROWED_BYTE_ARRAY_H_
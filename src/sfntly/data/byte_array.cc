@@ -94,6 +94,12 @@ int32_t ByteArray::Put(int32_t index,
   return bytes_written;
 }
 
+const uint8_t* ByteArray::ContiguousStorage() {
+  if (Length() <= 0)
+    return NULL;
+  return Begin();
+}
+
 int32_t ByteArray::CopyTo(ByteArray* array) {
   return CopyTo(array, 0, Length());
 }
@@ -109,6 +115,19 @@ int32_t ByteArray::CopyTo(int32_t dst_offset, ByteArray* array,
     return -1;
   }
 
+  // Both sides keep their bytes contiguously, so hand the source range to the
+  // destination in a single Put() rather than through a bounce buffer.
+  const uint8_t* storage = ContiguousStorage();
+  if (storage) {
+    if (src_offset < 0 || src_offset >= Length() || length <= 0)
+      return 0;
+    int32_t actual_length = std::min<int32_t>(length, Length() - src_offset);
+    return array->Put(dst_offset,
+                      const_cast<uint8_t*>(storage) + src_offset,
+                      0,
+                      actual_length);
+  }
+
   std::vector<uint8_t> b(COPY_BUFFER_SIZE);
   int32_t bytes_read = 0;
   int32_t index = 0;
@@ -130,6 +149,15 @@ int32_t ByteArray::CopyTo(OutputStream* os) {
 }
 
 int32_t ByteArray::CopyTo(OutputStream* os, int32_t offset, int32_t length) {
+  const uint8_t* storage = ContiguousStorage();
+  if (storage) {
+    if (offset < 0 || offset >= Length() || length <= 0)
+      return 0;
+    int32_t actual_length = std::min<int32_t>(length, Length() - offset);
+    os->Write(const_cast<uint8_t*>(storage), offset, actual_length);
+    return actual_length;
+  }
+
   std::vector<uint8_t> b(COPY_BUFFER_SIZE);
   int32_t bytes_read = 0;
   int32_t index = 0;
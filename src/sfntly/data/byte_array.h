@@ -17,6 +17,7 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_BYTE_ARRAY_H_
 #define SFNTLY_CPP_SRC_SFNTLY_DATA_BYTE_ARRAY_H_
 
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/port/type.h"
 #include "sfntly/port/input_stream.h"
@@ -27,7 +28,7 @@ namespace sfntly {
 // An abstraction to a contiguous array of bytes.
 // C++ port of this class assumes that the data are stored in a linear region
 // like std::vector.
-class ByteArray : virtual public RefCount {
+class ByteArray : public RefCount, public ArenaAllocated {
  public:
   virtual ~ByteArray();
 
@@ -42,6 +43,11 @@ class ByteArray : virtual public RefCount {
   // Determines whether or not this array is growable or of fixed size.
   bool growable() const { return growable_; }
 
+  // Determines whether or not this array rejects writes. Put() on a read-only
+  // array writes nothing, so data that will be edited must be copied into a
+  // writable array first.
+  virtual bool read_only() const { return false; }
+
   int32_t SetFilledLength(int32_t filled_length);
 
   // Gets the byte from the given index.
@@ -93,6 +99,13 @@ class ByteArray : virtual public RefCount {
                       int32_t offset,
                       int32_t length);
 
+  // C++ port only: gets the contiguous block of memory holding the readable
+  // bytes of the array, so that they can be copied or read in place instead of
+  // going through Get(). The pointer is invalidated by anything that may grow
+  // or close the array.
+  // @return the first readable byte; NULL if the array is empty
+  virtual const uint8_t* ContiguousStorage();
+
   // Fully copies this ByteArray to another ByteArray to the extent that the
   // destination array has storage for the data copied.
   virtual int32_t CopyTo(ByteArray* array);
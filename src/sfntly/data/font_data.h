@@ -20,6 +20,7 @@
 #include <limits.h>
 
 #include "sfntly/data/byte_array.h"
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/port/type.h"
 
@@ -46,7 +47,7 @@ struct DataSize {
   };
 };
 
-class FontData : virtual public RefCount {
+class FontData : public RefCount, public ArenaAllocated {
  public:
   // Gets the maximum size of the FontData. This is the maximum number of bytes
   // that the font data can hold and all of it may not be filled with data or
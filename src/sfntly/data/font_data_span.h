@@ -0,0 +1,104 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_FONT_DATA_SPAN_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_FONT_DATA_SPAN_H_
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// A non-owning view of contiguous font data: a pointer and a length, passed by
+// value. Spans are obtained from ReadableFontData::Span() and are only valid
+// while the ReadableFontData they came from is alive and its underlying array
+// is not resized.
+// Unlike ReadableFontData, reads are not bounds checked. Callers check a range
+// once with Contains() (or get it through Subspan()) and then read from it
+// with the inlined accessors below, which assert in debug builds only.
+class FontDataSpan {
+ public:
+  FontDataSpan() : data_(NULL), length_(0) {}
+  FontDataSpan(const uint8_t* data, int32_t length)
+      : data_(data), length_(data ? length : 0) {}
+
+  const uint8_t* data() const { return data_; }
+  int32_t length() const { return length_; }
+
+  // A default constructed span, or one returned by a failed Subspan(), is
+  // invalid. A zero length span into valid data is still valid.
+  bool IsValid() const { return data_ != NULL; }
+
+  // @return true if size bytes starting at offset lie within the span
+  bool Contains(int32_t offset, int32_t size) const {
+    return offset >= 0 && size >= 0 && offset <= length_ - size;
+  }
+
+  // Makes a narrower view of this span.
+  // @param offset the start of the subspan
+  // @param length the number of bytes in the subspan
+  // @return the subspan; an invalid span if the range is out of bounds
+  FontDataSpan Subspan(int32_t offset, int32_t length) const {
+    if (!IsValid() || !Contains(offset, length))
+      return FontDataSpan();
+    return FontDataSpan(data_ + offset, length);
+  }
+
+  int32_t ReadUByte(int32_t index) const {
+    assert(Contains(index, kUByteSize));
+    return data_[index];
+  }
+
+  int32_t ReadByte(int32_t index) const {
+    assert(Contains(index, kUByteSize));
+    return static_cast<int8_t>(data_[index]);
+  }
+
+  int32_t ReadUShort(int32_t index) const {
+    assert(Contains(index, kUShortSize));
+    return (data_[index] << 8) | data_[index + 1];
+  }
+
+  int32_t ReadShort(int32_t index) const {
+    return static_cast<int16_t>(ReadUShort(index));
+  }
+
+  int64_t ReadULong(int32_t index) const {
+    assert(Contains(index, kULongSize));
+    return (static_cast<uint32_t>(data_[index]) << 24) |
+           (data_[index + 1] << 16) | (data_[index + 2] << 8) |
+           data_[index + 3];
+  }
+
+  int32_t ReadLong(int32_t index) const {
+    return static_cast<int32_t>(ReadULong(index));
+  }
+
+ private:
+  enum {
+    kUByteSize = 1,
+    kUShortSize = 2,
+    kULongSize = 4
+  };
+
+  const uint8_t* data_;
+  int32_t length_;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_FONT_DATA_SPAN_H_
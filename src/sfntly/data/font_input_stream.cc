@@ -99,20 +99,34 @@ int32_t FontInputStream::Read(std::vector<uint8_t>* b) {
   return Read(b, 0, b->size());
 }
 
+int32_t FontInputStream::Read(uint8_t* b, int32_t offset, int32_t length) {
+  if (!stream_ || offset < 0 || length < 0 ||
+      (bounded_ && position_ >= length_)) {
+    return -1;
+  }
+  int32_t bytes_to_read =
+      bounded_ ? std::min<int32_t>(length, (int32_t)(length_ - position_)) :
+                 length;
+  int32_t bytes_read = stream_->Read(b, offset, bytes_to_read);
+  if (bytes_read > 0)
+    position_ += bytes_read;
+  return bytes_read;
+}
+
 int32_t FontInputStream::ReadChar() {
   return Read();
 }
 
 int32_t FontInputStream::ReadUShort() {
-  return 0xffff & (Read() << 8 | Read());
+  return (int32_t)ReadBigEndian(2);
 }
 
 int32_t FontInputStream::ReadShort() {
-  return ((Read() << 8 | Read()) << 16) >> 16;
+  return (int16_t)ReadBigEndian(2);
 }
 
 int32_t FontInputStream::ReadUInt24() {
-  return 0xffffff & (Read() << 16 | Read() << 8 | Read());
+  return (int32_t)ReadBigEndian(3);
 }
 
 int64_t FontInputStream::ReadULong() {
@@ -125,7 +139,7 @@ int32_t FontInputStream::ReadULongAsInt() {
 }
 
 int32_t FontInputStream::ReadLong() {
-  return Read() << 24 | Read() << 16 | Read() << 8 | Read();
+  return (int32_t)ReadBigEndian(4);
 }
 
 int32_t FontInputStream::ReadFixed() {
@@ -136,6 +150,17 @@ int64_t FontInputStream::ReadDateTimeAsLong() {
   return (int64_t)ReadULong() << 32 | ReadULong();
 }
 
+int64_t FontInputStream::ReadBigEndian(int32_t size) {
+  uint8_t b[4] = { 0xff, 0xff, 0xff, 0xff };
+  assert(size > 0 && size <= 4);
+  Read(b, 0, size);
+  int64_t value = 0;
+  for (int32_t i = 0; i < size; ++i) {
+    value = value << 8 | b[i];
+  }
+  return value;
+}
+
 int64_t FontInputStream::Skip(int64_t n) {
   if (stream_) {
     int64_t skipped = stream_->Skip(n);
@@ -69,6 +69,7 @@ class FontInputStream : public InputStream {
   virtual int32_t Read();
   virtual int32_t Read(std::vector<uint8_t>* buffer);
   virtual int32_t Read(std::vector<uint8_t>* buffer, int32_t offset, int32_t length);
+  virtual int32_t Read(uint8_t* buffer, int32_t offset, int32_t length);
 
   // Get the current position in the stream in bytes.
   // @return the current position in bytes
@@ -86,6 +87,11 @@ class FontInputStream : public InputStream {
   virtual int64_t Skip(int64_t n);  // n can be negative.
 
  private:
+  // Reads a big endian value of size bytes in one read from the wrapped
+  // stream. Bytes past the end of the stream read as 0xff, as Read() returning
+  // -1 would.
+  int64_t ReadBigEndian(int32_t size);
+
   InputStream* stream_;
   int64_t position_;
   int64_t length_;  // Bound on length of data to read.
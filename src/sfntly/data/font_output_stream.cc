@@ -74,6 +74,16 @@ void FontOutputStream::Write(uint8_t* b, int32_t off, int32_t len) {
   position_ += len;
 }
 
+int32_t FontOutputStream::WriteFileRange(int fd,
+                                         int64_t offset,
+                                         int32_t length) {
+  assert(stream_);
+  int32_t copied = stream_->WriteFileRange(fd, offset, length);
+  if (copied > 0)
+    position_ += copied;
+  return copied;
+}
+
 void FontOutputStream::WriteChar(uint8_t c) {
   Write(c);
 }
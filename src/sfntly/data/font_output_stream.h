@@ -52,6 +52,7 @@ class FontOutputStream : public OutputStream {
   virtual void Write(std::vector<uint8_t>* b);
   virtual void Write(std::vector<uint8_t>* b, int32_t off, int32_t len);
   virtual void Write(uint8_t* b, int32_t off, int32_t len);
+  virtual int32_t WriteFileRange(int fd, int64_t offset, int32_t length);
   virtual void WriteChar(uint8_t c);
   virtual void WriteUShort(int32_t us);
   virtual void WriteShort(int32_t s);
@@ -23,8 +23,7 @@ namespace sfntly {
 
 // Note: This is not really a port of Java version. Instead, this wraps a
 //       std::vector inside and let it grow by calling resize().
-class GrowableMemoryByteArray : public ByteArray,
-                                public RefCounted<GrowableMemoryByteArray> {
+class GrowableMemoryByteArray : public ByteArray {
  public:
   GrowableMemoryByteArray();
   virtual ~GrowableMemoryByteArray();
@@ -0,0 +1,194 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/data/mapped_byte_array.h"
+
+#if !defined (WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <limits.h>
+#include <string.h>
+
+#include "sfntly/port/exception_type.h"
+
+namespace sfntly {
+
+const int32_t MappedByteArray::kMinFileRangeLength = 16 * 1024;
+
+#if !defined (WIN32)
+namespace {
+
+int AdviceFromHint(int32_t hint) {
+  switch (hint) {
+    case MappedAccessHint::kSequential:
+      return MADV_SEQUENTIAL;
+    case MappedAccessHint::kRandom:
+      return MADV_RANDOM;
+    case MappedAccessHint::kWillNeed:
+      return MADV_WILLNEED;
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+}  // namespace
+#endif
+
+// static
+CALLER_ATTACH MappedByteArray* MappedByteArray::Map(const char* file_path,
+                                                    int32_t hint) {
+#if defined (WIN32)
+  UNREFERENCED_PARAMETER(file_path);
+  UNREFERENCED_PARAMETER(hint);
+  return NULL;
+#else
+  if (!file_path)
+    return NULL;
+  int fd = open(file_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+      st.st_size > INT_MAX) {
+    close(fd);
+    return NULL;
+  }
+  int32_t length = static_cast<int32_t>(st.st_size);
+  void* b = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (b == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  MappedByteArrayPtr array =
+      new MappedByteArray(static_cast<uint8_t*>(b), length, fd);
+  array->Advise(0, length, hint);
+  return array.Detach();
+#endif
+}
+
+// static
+CALLER_ATTACH MappedByteArray* MappedByteArray::Map(const char* file_path) {
+  return Map(file_path, MappedAccessHint::kRandom);
+}
+
+MappedByteArray::MappedByteArray(uint8_t* b, int32_t length, int fd)
+    : ByteArray(length, length), b_(b), fd_(fd) {
+}
+
+MappedByteArray::~MappedByteArray() {
+  Close();
+}
+
+void MappedByteArray::Advise(int32_t offset, int32_t length, int32_t hint) {
+#if defined (WIN32)
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+  UNREFERENCED_PARAMETER(hint);
+#else
+  if (!b_ || offset < 0 || length <= 0 || offset >= Size())
+    return;
+  length = std::min<int32_t>(length, Size() - offset);
+  // madvise() wants a page aligned start address.
+  size_t page_mask = static_cast<size_t>(sysconf(_SC_PAGESIZE)) - 1;
+  uintptr_t start = reinterpret_cast<uintptr_t>(b_ + offset);
+  uintptr_t aligned_start = start & ~page_mask;
+  madvise(reinterpret_cast<void*>(aligned_start),
+          length + (start - aligned_start),
+          AdviceFromHint(hint));
+#endif
+}
+
+int32_t MappedByteArray::CopyTo(OutputStream* os,
+                                int32_t offset,
+                                int32_t length) {
+  assert(os);
+  if (offset < 0 || offset >= Length() || length <= 0)
+    return 0;
+  int32_t actual_length = std::min<int32_t>(length, Length() - offset);
+  int32_t copied = 0;
+  if (fd_ >= 0 && actual_length >= kMinFileRangeLength) {
+    copied = os->WriteFileRange(fd_, offset, actual_length);
+    if (copied < 0)
+      return 0;
+  }
+  if (copied < actual_length)
+    os->Write(b_, offset + copied, actual_length - copied);
+  return actual_length;
+}
+
+void MappedByteArray::InternalPut(int32_t index, uint8_t b) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+#if defined (SFNTLY_NO_EXCEPTION)
+  // Nothing else reports the dropped write.
+  assert(!read_only());
+#else
+  throw IOException("Attempt to write to a read-only mapped array");
+#endif
+}
+
+int32_t MappedByteArray::InternalPut(int32_t index,
+                                     uint8_t* b,
+                                     int32_t offset,
+                                     int32_t length) {
+  UNREFERENCED_PARAMETER(index);
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+#if defined (SFNTLY_NO_EXCEPTION)
+  // Nothing else reports the dropped write.
+  assert(!read_only());
+#else
+  throw IOException("Attempt to write to a read-only mapped array");
+#endif
+  return 0;
+}
+
+uint8_t MappedByteArray::InternalGet(int32_t index) {
+  return b_[index];
+}
+
+int32_t MappedByteArray::InternalGet(int32_t index,
+                                     uint8_t* b,
+                                     int32_t offset,
+                                     int32_t length) {
+  assert(b);
+  memcpy(b + offset, b_ + index, length);
+  return length;
+}
+
+void MappedByteArray::Close() {
+#if !defined (WIN32)
+  if (b_) {
+    munmap(b_, Size());
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+#endif
+  b_ = NULL;
+  fd_ = -1;
+}
+
+uint8_t* MappedByteArray::Begin() {
+  return b_;
+}
+
+}  // namespace sfntly
@@ -0,0 +1,111 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
+#define SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
+
+#include "sfntly/data/byte_array.h"
+
+namespace sfntly {
+
+// Paging hints passed on to madvise() for a mapped region.
+struct MappedAccessHint {
+  enum {
+    kNormal = 0,
+    kSequential = 1,
+    kRandom = 2,
+    kWillNeed = 3
+  };
+};
+
+// A read-only ByteArray backed by a memory mapping of a font file. Fonts
+// loaded from it slice their table data straight out of the mapping, so the
+// file is never copied into the heap and processes mapping the same file share
+// one page cache copy. The mapping lives as long as the last reference to the
+// array.
+// Writes are rejected: Put() on a MappedByteArray writes nothing, and
+// asserts in debug builds.
+// The file stays open while mapped so that large ranges copied to a file
+// backed OutputStream can be handed to the kernel instead of being written
+// from the mapping.
+class MappedByteArray : public ByteArray {
+ public:
+  // Maps the file at the given path.
+  // @param file_path the font file to map
+  // @param hint the initial paging hint for the whole file, one of
+  //        MappedAccessHint
+  // @return the mapped array; NULL if the file could not be opened or mapped,
+  //         is empty or is larger than a ByteArray can address
+  static CALLER_ATTACH MappedByteArray* Map(const char* file_path,
+                                            int32_t hint);
+  static CALLER_ATTACH MappedByteArray* Map(const char* file_path);
+
+  virtual ~MappedByteArray();
+
+  // Gives the kernel a paging hint for a range of the mapping. The range is
+  // widened to page boundaries.
+  // @param offset the start of the range
+  // @param length the length of the range
+  // @param hint one of MappedAccessHint
+  void Advise(int32_t offset, int32_t length, int32_t hint);
+
+  virtual bool read_only() const { return true; }
+
+  // Ranges of at least kMinFileRangeLength are offered to the stream's
+  // WriteFileRange() first.
+  // @return the number of bytes written; 0 if the stream failed while the
+  //         kernel was copying
+  virtual int32_t CopyTo(OutputStream* os, int32_t offset, int32_t length);
+
+  // Make gcc -Woverloaded-virtual happy.
+  virtual int32_t CopyTo(ByteArray* array) { return ByteArray::CopyTo(array); }
+  virtual int32_t CopyTo(ByteArray* array, int32_t offset, int32_t length) {
+    return ByteArray::CopyTo(array, offset, length);
+  }
+  virtual int32_t CopyTo(int32_t dst_offset,
+                         ByteArray* array,
+                         int32_t src_offset,
+                         int32_t length) {
+    return ByteArray::CopyTo(dst_offset, array, src_offset, length);
+  }
+  virtual int32_t CopyTo(OutputStream* os) { return ByteArray::CopyTo(os); }
+
+ protected:
+  virtual void InternalPut(int32_t index, uint8_t b);
+  virtual int32_t InternalPut(int32_t index,
+                              uint8_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual uint8_t InternalGet(int32_t index);
+  virtual int32_t InternalGet(int32_t index,
+                              uint8_t* b,
+                              int32_t offset,
+                              int32_t length);
+  virtual void Close();
+  virtual uint8_t* Begin();
+
+ private:
+  // Below this a system call costs more than copying out of the mapping.
+  static const int32_t kMinFileRangeLength;
+
+  MappedByteArray(uint8_t* b, int32_t length, int fd);
+
+  uint8_t* b_;
+  int fd_;
+};
+typedef Ptr<MappedByteArray> MappedByteArrayPtr;
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_DATA_MAPPED_BYTE_ARRAY_H_
@@ -43,7 +43,7 @@ int32_t MemoryByteArray::CopyTo(OutputStream* os,
 
 void MemoryByteArray::Init() {
   if (allocated_ && b_ == NULL) {
-    b_ = new uint8_t[Size()];
+    b_ = static_cast<uint8_t*>(ArenaAllocated::Allocate(Size()));
     memset(b_, 0, Size());
   }
 }
@@ -80,7 +80,7 @@ int32_t MemoryByteArray::InternalGet(int32_t index,
 
 void MemoryByteArray::Close() {
   if (allocated_ && b_) {
-    delete[] b_;
+    ArenaAllocated::Deallocate(b_);
   }
   b_ = NULL;
 }
@@ -21,7 +21,7 @@
 
 namespace sfntly {
 
-class MemoryByteArray : public ByteArray, public RefCounted<MemoryByteArray> {
+class MemoryByteArray : public ByteArray {
  public:
   // Construct a new MemoryByteArray with a new array of the size given. It is
   // assumed that none of the array is filled and readable.
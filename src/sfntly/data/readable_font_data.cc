@@ -22,6 +22,8 @@
 
 #include "sfntly/data/memory_byte_array.h"
 #include "sfntly/data/writable_font_data.h"
+#include "sfntly/math/font_checksum.h"
+#include "sfntly/port/endian.h"
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
@@ -47,16 +49,20 @@ ReadableFontData* ReadableFontData::CreateReadableFontData(std::vector<uint8_t>*
 }
 
 int64_t ReadableFontData::Checksum() {
-  AutoLock lock(checksum_lock_);
-  if (!checksum_set_) {
-    ComputeChecksum();
+  // The computation is idempotent, so racing first callers simply store the
+  // same value; the release/acquire pair publishes it to later readers.
+  if (checksum_set_.load(std::memory_order_acquire)) {
+    return checksum_.load(std::memory_order_relaxed);
   }
-  return checksum_;
+  int64_t checksum = ComputeChecksum();
+  checksum_.store(checksum, std::memory_order_relaxed);
+  checksum_set_.store(true, std::memory_order_release);
+  return checksum;
 }
 
 void ReadableFontData::SetCheckSumRanges(const std::vector<int32_t>& ranges) {
   checksum_range_ = ranges;
-  checksum_set_ = false;  // UNIMPLEMENTED: atomicity
+  checksum_set_.store(false, std::memory_order_release);
 }
 
 int32_t ReadableFontData::ReadUByte(int32_t index) {
@@ -209,6 +215,48 @@ int32_t ReadableFontData::ReadFUFWord(int32_t index) {
   return ReadUShort(index);
 }
 
+int32_t ReadableFontData::ReadUShortArray(int32_t index,
+                                          int32_t count,
+                                          uint16_t* values) {
+  int32_t read = ReadRun(index, count, DataSize::kUSHORT,
+                         reinterpret_cast<uint8_t*>(values));
+  FromBE16Array(values, read);
+  return read;
+}
+
+int32_t ReadableFontData::ReadShortArray(int32_t index,
+                                         int32_t count,
+                                         int16_t* values) {
+  return ReadUShortArray(index, count, reinterpret_cast<uint16_t*>(values));
+}
+
+int32_t ReadableFontData::ReadULongArray(int32_t index,
+                                         int32_t count,
+                                         uint32_t* values) {
+  int32_t read = ReadRun(index, count, DataSize::kULONG,
+                         reinterpret_cast<uint8_t*>(values));
+  FromBE32Array(values, read);
+  return read;
+}
+
+int32_t ReadableFontData::ReadLongArray(int32_t index,
+                                        int32_t count,
+                                        int32_t* values) {
+  return ReadULongArray(index, count, reinterpret_cast<uint32_t*>(values));
+}
+
+FontDataSpan ReadableFontData::Span() {
+  int32_t length = Length();
+  const uint8_t* storage = array_->ContiguousStorage();
+  if (length <= 0 || !storage)
+    return FontDataSpan();
+  return FontDataSpan(storage + BoundOffset(0), length);
+}
+
+FontDataSpan ReadableFontData::Span(int32_t offset, int32_t length) {
+  return Span().Subspan(offset, length);
+}
+
 int32_t ReadableFontData::CopyTo(OutputStream* os) {
   return array_->CopyTo(os, BoundOffset(0), Length());
 }
@@ -352,8 +400,29 @@ ReadableFontData::ReadableFontData(ReadableFontData* data,
       checksum_(0) {
 }
 
-void ReadableFontData::ComputeChecksum() {
-  // TODO(arthurhsu): IMPLEMENT: synchronization/atomicity
+int32_t ReadableFontData::ReadRun(int32_t index,
+                                  int32_t count,
+                                  int32_t value_size,
+                                  uint8_t* b) {
+  if (count <= 0)
+    return 0;
+  assert(b);
+  int64_t length = static_cast<int64_t>(count) * value_size;
+  if (index < 0 || index + length > Length()) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IndexOutOfBoundException(
+        "Index attempted to be read from is out of bounds", index);
+#endif
+    return 0;
+  }
+  if (array_->Get(BoundOffset(index), b, 0, static_cast<int32_t>(length)) !=
+      length) {
+    return 0;
+  }
+  return count;
+}
+
+int64_t ReadableFontData::ComputeChecksum() {
   int64_t sum = 0;
   if (checksum_range_.empty()) {
     sum = ComputeCheckSum(0, Length());
@@ -368,16 +437,21 @@ void ReadableFontData::ComputeChecksum() {
     }
   }
 
-  checksum_ = sum & 0xffffffffL;
-  checksum_set_ = true;
+  return sum & 0xffffffffL;
 }
 
 int64_t ReadableFontData::ComputeCheckSum(int32_t low_bound,
                                           int32_t high_bound) {
   int64_t sum = 0;
   // Checksum all whole 4-byte chunks.
-  for (int32_t i = low_bound; i <= high_bound - 4; i += 4) {
-    sum += ReadULong(i);
+  int32_t words = (high_bound - low_bound) / 4;
+  FontDataSpan span = Span();
+  if (words > 0 && low_bound >= 0 && span.Contains(low_bound, words * 4)) {
+    sum += FontChecksum::SumBigEndianWords(span.data() + low_bound, words);
+  } else {
+    for (int32_t i = low_bound; i <= high_bound - 4; i += 4) {
+      sum += ReadULong(i);
+    }
   }
 
   // Add last fragment if not 4-byte multiple
@@ -17,8 +17,10 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_DATA_READABLE_FONT_DATA_H_
 #define SFNTLY_CPP_SRC_SFNTLY_DATA_READABLE_FONT_DATA_H_
 
+#include <atomic>
+
 #include "sfntly/data/font_data.h"
-#include "sfntly/port/lock.h"
+#include "sfntly/data/font_data_span.h"
 
 namespace sfntly {
 
@@ -45,8 +47,7 @@ class WritableFontData;
 //               January 1, 1904. The value is represented as a signed 64-bit
 //               integer.
 
-class ReadableFontData : public FontData,
-                         public RefCounted<ReadableFontData> {
+class ReadableFontData : public FontData {
  public:
   explicit ReadableFontData(ByteArray* array);
   virtual ~ReadableFontData();
@@ -64,13 +65,15 @@ class ReadableFontData : public FontData,
   // the resulting value is truncated to 32 bits. If the data length in bytes is
   // not an integral multiple of 4 then any remaining bytes are treated as the
   // start of a 4 byte sequence whose remaining bytes are zero.
+  // The result is cached; concurrent callers may each compute it the first
+  // time but never block each other.
   // @return the checksum
   int64_t Checksum();
 
   // Sets the bounds to use for computing the checksum. These bounds are in
   // begin and end pairs. If an odd number is given then the final range is
   // assumed to extend to the end of the data. The lengths of each range must be
-  // a multiple of 4.
+  // a multiple of 4. Must not race with Checksum() on another thread.
   // @param ranges the range bounds to use for the checksum
   void SetCheckSumRanges(const std::vector<int32_t>& ranges);
 
@@ -171,6 +174,34 @@ class ReadableFontData : public FontData,
   // @throws IndexOutOfBoundsException if index is outside the FontData's range
   virtual int32_t ReadFUFWord(int32_t index);
 
+  // Read a run of USHORTs starting at the given index. The whole run is bounds
+  // checked once and converted from big endian in bulk, which is much cheaper
+  // than calling ReadUShort() for each element.
+  // @param index index into the font data of the first USHORT
+  // @param count the number of USHORTs to read
+  // @param values the destination; must have room for count elements
+  // @return the number of USHORTs read; 0 if any part of the run is outside
+  //         the FontData's range
+  // @throws IndexOutOfBoundsException if the run is outside the FontData's
+  //         range
+  virtual int32_t ReadUShortArray(int32_t index, int32_t count,
+                                  uint16_t* values);
+
+  // Read a run of SHORTs starting at the given index.
+  // @see ReadUShortArray
+  virtual int32_t ReadShortArray(int32_t index, int32_t count,
+                                 int16_t* values);
+
+  // Read a run of ULONGs starting at the given index.
+  // @see ReadUShortArray
+  virtual int32_t ReadULongArray(int32_t index, int32_t count,
+                                 uint32_t* values);
+
+  // Read a run of LONGs starting at the given index.
+  // @see ReadUShortArray
+  virtual int32_t ReadLongArray(int32_t index, int32_t count,
+                                int32_t* values);
+
   // Note: Not ported because they just throw UnsupportedOperationException()
   //       in Java.
   /*
@@ -178,6 +209,17 @@ class ReadableFontData : public FontData,
   virtual int64_t ReadF2Dot14(int32_t index);
   */
 
+  // Gets a span over the readable bytes of this FontData.
+  // @return the span; an invalid span if the data is empty
+  virtual FontDataSpan Span();
+
+  // Gets a span over a range of this FontData. The range is checked once
+  // here so that reads through the span need no further checks.
+  // @param offset the start of the range
+  // @param length the number of bytes in the range
+  // @return the span; an invalid span if the range is outside the FontData
+  virtual FontDataSpan Span(int32_t offset, int32_t length);
+
   // Copy the FontData to an OutputStream.
   // @param os the destination
   // @return number of bytes copied
@@ -287,25 +329,32 @@ class ReadableFontData : public FontData,
   ReadableFontData(ReadableFontData* data, int32_t offset, int32_t length);
 
  private:
+  // Read count values of value_size bytes each into b after checking once that
+  // the whole run lies within the FontData.
+  // @return count if the run was read; 0 otherwise
+  int32_t ReadRun(int32_t index,
+                  int32_t count,
+                  int32_t value_size,
+                  uint8_t* b);
+
   // Compute the checksum for the font data using any ranges set for the
   // calculation.
-  void ComputeChecksum();
+  // @return the checksum truncated to 32 bits
+  int64_t ComputeChecksum();
 
   // Do the actual computation of the checksum for a range using the
   // TrueType/OpenType checksum algorithm. The range used is from the low bound
   // to the high bound in steps of four bytes. If any of the bytes within that 4
   // byte segment are not readable then it will considered a zero for
-  // calculation.
-  // Only called from within a synchronized method so it does not need to be
-  // synchronized itself.
+  // calculation. Whole words that lie within the data are summed by the
+  // vectorized FontChecksum kernel.
   // @param lowBound first position to start a 4 byte segment on
   // @param highBound last possible position to start a 4 byte segment on
   // @return the checksum for the total range
   int64_t ComputeCheckSum(int32_t low_bound, int32_t high_bound);
 
-  Lock checksum_lock_;
-  bool checksum_set_;
-  int64_t checksum_;
+  std::atomic<bool> checksum_set_;
+  std::atomic<int64_t> checksum_;
   std::vector<int32_t> checksum_range_;
 };
 typedef Ptr<ReadableFontData> ReadableFontDataPtr;
@@ -16,11 +16,14 @@
 
 #include "sfntly/data/writable_font_data.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <limits>
 
 #include "sfntly/data/memory_byte_array.h"
 #include "sfntly/data/growable_memory_byte_array.h"
+#include "sfntly/port/endian.h"
 
 namespace sfntly {
 
@@ -158,6 +161,63 @@ int32_t WritableFontData::WriteDateTime(int32_t index, int64_t date) {
   return 8;
 }
 
+int32_t WritableFontData::WriteUShortArray(int32_t index,
+                                           const uint16_t* values,
+                                           int32_t count) {
+  // Convert through a small stack buffer so that no allocation is needed.
+  uint16_t buffer[256];
+  int32_t written = 0;
+  for (int32_t i = 0; i < count; i += 256) {
+    int32_t n = std::min<int32_t>(256, count - i);
+    memcpy(buffer, values + i, n * DataSize::kUSHORT);
+    ToBE16Array(buffer, n);
+    int32_t bytes = WriteBytes(index + written,
+                               reinterpret_cast<uint8_t*>(buffer),
+                               0,
+                               n * DataSize::kUSHORT);
+    written += bytes;
+    if (bytes != n * DataSize::kUSHORT)
+      break;
+  }
+  return written;
+}
+
+int32_t WritableFontData::WriteShortArray(int32_t index,
+                                          const int16_t* values,
+                                          int32_t count) {
+  return WriteUShortArray(index,
+                          reinterpret_cast<const uint16_t*>(values),
+                          count);
+}
+
+int32_t WritableFontData::WriteULongArray(int32_t index,
+                                          const uint32_t* values,
+                                          int32_t count) {
+  uint32_t buffer[128];
+  int32_t written = 0;
+  for (int32_t i = 0; i < count; i += 128) {
+    int32_t n = std::min<int32_t>(128, count - i);
+    memcpy(buffer, values + i, n * DataSize::kULONG);
+    ToBE32Array(buffer, n);
+    int32_t bytes = WriteBytes(index + written,
+                               reinterpret_cast<uint8_t*>(buffer),
+                               0,
+                               n * DataSize::kULONG);
+    written += bytes;
+    if (bytes != n * DataSize::kULONG)
+      break;
+  }
+  return written;
+}
+
+int32_t WritableFontData::WriteLongArray(int32_t index,
+                                         const int32_t* values,
+                                         int32_t count) {
+  return WriteULongArray(index,
+                         reinterpret_cast<const uint32_t*>(values),
+                         count);
+}
+
 void WritableFontData::CopyFrom(InputStream* is, int32_t length) {
   array_->CopyFrom(is, length);
 }
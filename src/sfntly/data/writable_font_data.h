@@ -168,6 +168,32 @@ class WritableFontData : public ReadableFontData {
   // @throws IndexOutOfBoundsException if index is outside the FontData's range
   virtual int32_t WriteDateTime(int32_t index, int64_t date);
 
+  // Write a run of USHORTs starting at the given index. The values are
+  // converted to big endian in bulk and written through a single bounds check
+  // per chunk rather than one per byte.
+  // @param index index into the font data of the first USHORT
+  // @param values the USHORTs to write
+  // @param count the number of USHORTs to write
+  // @return the number of bytes actually written
+  // @throws IndexOutOfBoundsException if index is outside the FontData's range
+  virtual int32_t WriteUShortArray(int32_t index, const uint16_t* values,
+                                   int32_t count);
+
+  // Write a run of SHORTs starting at the given index.
+  // @see WriteUShortArray
+  virtual int32_t WriteShortArray(int32_t index, const int16_t* values,
+                                  int32_t count);
+
+  // Write a run of ULONGs starting at the given index.
+  // @see WriteUShortArray
+  virtual int32_t WriteULongArray(int32_t index, const uint32_t* values,
+                                  int32_t count);
+
+  // Write a run of LONGs starting at the given index.
+  // @see WriteUShortArray
+  virtual int32_t WriteLongArray(int32_t index, const int32_t* values,
+                                 int32_t count);
+
   // Copy from the InputStream into this FontData.
   // @param is the source
   // @param length the number of bytes to copy
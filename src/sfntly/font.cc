@@ -17,20 +17,29 @@
 #include "sfntly/font.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include <algorithm>
+#include <condition_variable>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <typeinfo>
+#include <utility>
 
 #include "sfntly/data/font_input_stream.h"
+#include "sfntly/data/memory_byte_array.h"
 #include "sfntly/font_factory.h"
 #include "sfntly/math/fixed1616.h"
+#include "sfntly/math/font_checksum.h"
 #include "sfntly/math/font_math.h"
+#include "sfntly/port/atomic.h"
 #include "sfntly/port/exception_type.h"
+#include "sfntly/port/memory_output_stream.h"
 #include "sfntly/table/core/font_header_table.h"
 #include "sfntly/table/core/horizontal_device_metrics_table.h"
 #include "sfntly/table/core/horizontal_header_table.h"
@@ -54,6 +63,147 @@ bool IsValidHeaderRegion(int32_t data_length, int32_t offset, int32_t length) {
          offset + length <= data_length;
 }
 
+// The offset of checkSumAdjustment within the head table, and the value the
+// whole font must sum to once it is set.
+const int32_t kHeadCheckSumAdjustmentOffset = 8;
+const int64_t kCheckSumAdjustmentMagic = 0xB1B0AFBAL;
+
+void PutULong(uint8_t* b, int64_t value) {
+  b[0] = static_cast<uint8_t>(value >> 24);
+  b[1] = static_cast<uint8_t>(value >> 16);
+  b[2] = static_cast<uint8_t>(value >> 8);
+  b[3] = static_cast<uint8_t>(value);
+}
+
+int64_t GetULong(const uint8_t* b) {
+  return (static_cast<int64_t>(b[0]) << 24) | (b[1] << 16) | (b[2] << 8) |
+         b[3];
+}
+
+bool HasCheckSumAdjustment(const Header* record) {
+  return record->tag() == Tag::head &&
+         record->length() >= kHeadCheckSumAdjustmentOffset + 4;
+}
+
+// Since every table starts on a 4-byte boundary and is zero padded, the
+// checksum of the whole font is the checksum of the directory plus those of
+// the tables it lists. The head table checksum already treats
+// checkSumAdjustment as zero.
+int64_t ComputeCheckSumAdjustment(const uint8_t* directory,
+                                  size_t directory_size,
+                                  const TableHeaderList& records) {
+  uint64_t sum = FontChecksum::SumBigEndianWords(directory,
+                                                 directory_size / 4);
+  for (size_t i = 0; i < records.size(); ++i) {
+    sum += records[i]->checksum();
+  }
+  return (kCheckSumAdjustmentMagic - static_cast<int64_t>(sum)) & 0xffffffffL;
+}
+
+// Below this many bytes of table data, offering the copies to other threads
+// costs more than it saves.
+const int64_t kMinParallelSerializeSize = 256 * 1024;
+// The most helpers offered the copies of one font.
+const size_t kMaxSerializeHelpers = 8;
+// Tables are copied in pieces of at most this many bytes, so that a single
+// large glyf table is spread across threads too. A multiple of 4, so that the
+// checksums of the pieces of a table add up to the table's.
+const int32_t kSerializeChunkSize = 64 * 1024;
+
+// A piece of a table to copy into its region of a serialization buffer.
+struct RegionCopy {
+  const uint8_t* source;
+  uint8_t* destination;
+  int32_t length;
+  bool compute_checksum;
+  // The table the piece belongs to, and the sum of its words once copied.
+  size_t table;
+  uint64_t sum;
+};
+
+// The pieces of one serialization. They are claimed one at a time from a
+// shared counter by the serializing thread and by any helpers a TaskRunner
+// runs. Only raw memory is touched, never a ref counted object. Helpers keep
+// the copier alive themselves; one that starts after the serializing thread
+// has claimed every piece finds nothing left to do.
+class RegionCopier {
+ public:
+  explicit RegionCopier(std::vector<RegionCopy>* copies)
+      : next_(0), remaining_(copies->size()) {
+    copies_.swap(*copies);
+  }
+
+  // Copies pieces until none are left to claim.
+  void Run() {
+    size_t index;
+    while ((index = AtomicIncrement(&next_) - 1) < copies_.size()) {
+      RegionCopy& copy = copies_[index];
+      if (copy.compute_checksum) {
+        copy.sum = FontChecksum::CopyAndSumBigEndianWords(
+            copy.destination, copy.source, copy.length);
+      } else {
+        memcpy(copy.destination, copy.source, copy.length);
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--remaining_ == 0)
+        done_.notify_all();
+    }
+  }
+
+  // Waits for the pieces still being copied by helpers.
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (remaining_ > 0) {
+      done_.wait(lock);
+    }
+  }
+
+  const std::vector<RegionCopy>& copies() const { return copies_; }
+
+ private:
+  std::vector<RegionCopy> copies_;
+  size_t next_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  size_t remaining_;
+
+  NO_COPY_AND_ASSIGN(RegionCopier);
+};
+
+// Adds the pieces of a table whose data is contiguous in memory to copies;
+// other tables are copied into their region at once.
+// @param sum set to the sum of the words of a table copied at once
+// @return false if the table data could not be copied in full
+bool AddTableRegion(Table* table,
+                    const Header* record,
+                    bool compute_checksum,
+                    size_t table_index,
+                    uint8_t* buffer,
+                    std::vector<RegionCopy>* copies,
+                    uint64_t* sum) {
+  uint8_t* region = buffer + record->offset();
+  int32_t length = record->length();
+  ReadableFontData* data = table->ReadFontData();
+  FontDataSpan span = data->Span();
+  if (span.IsValid() && span.length() == length) {
+    for (int32_t offset = 0; offset < length; offset += kSerializeChunkSize) {
+      RegionCopy copy = {
+          span.data() + offset, region + offset,
+          std::min(kSerializeChunkSize, length - offset), compute_checksum,
+          table_index, 0};
+      copies->push_back(copy);
+    }
+    return true;
+  }
+  ByteArrayPtr array = new MemoryByteArray(region, length);
+  WritableFontDataPtr region_data = new WritableFontData(array);
+  if (data->CopyTo(region_data) != length)
+    return false;
+  if (compute_checksum)
+    *sum = FontChecksum::SumBigEndianWords(region, (length + 3) / 4);
+  return true;
+}
+
 }  // namespace
 
 /******************************************************************************
@@ -80,11 +230,133 @@ void Font::Serialize(OutputStream* os, std::vector<int32_t>* table_ordering) {
   std::vector<int32_t> final_table_ordering;
   GenerateTableOrdering(table_ordering, &final_table_ordering);
   TableHeaderList table_records;
-  BuildTableHeadersForSerialization(&final_table_ordering, &table_records);
+  BuildTableHeadersForSerialization(&final_table_ordering, &table_records,
+                                    true);
+
+  // Stage the directory so that it can be summed into the font checksum
+  // before the head table goes out.
+  MemoryOutputStream header_stream;
+  FontOutputStream header_fos(&header_stream);
+  SerializeHeader(&header_fos, &table_records);
+  int64_t checksum_adjustment =
+      ComputeCheckSumAdjustment(header_stream.Get(), header_stream.Size(),
+                                table_records);
 
   FontOutputStream fos(os);
+  fos.Write(header_stream.Get(), 0, header_stream.Size());
+  SerializeTables(&fos, &table_records, checksum_adjustment);
+}
+
+bool Font::Serialize(std::vector<uint8_t>* output,
+                     std::vector<int32_t>* table_ordering,
+                     TaskRunner* task_runner) {
+  assert(output);
+  assert(table_ordering);
+  std::vector<int32_t> final_table_ordering;
+  GenerateTableOrdering(table_ordering, &final_table_ordering);
+  TableHeaderList table_records;
+  BuildTableHeadersForSerialization(&final_table_ordering, &table_records,
+                                    false);
+
+  // The directory is small; write it through the regular stream path. Its
+  // size does not depend on the checksums, which are backpatched later.
+  MemoryOutputStream header_stream;
+  FontOutputStream fos(&header_stream);
   SerializeHeader(&fos, &table_records);
-  SerializeTables(&fos, &table_records);
+
+  std::vector<TablePtr> tables;
+  std::vector<bool> compute_checksums;
+  int64_t total_size = header_stream.Size();
+  for (size_t i = 0; i < table_records.size(); ++i) {
+    const HeaderPtr& record = table_records[i];
+    TablePtr table = GetTable(record->tag());
+    if (table == NULL || table->DataLength() != record->length()) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+      throw IOException("Table out of sync with font header.");
+#endif
+      return false;
+    }
+    tables.push_back(table);
+    compute_checksums.push_back(!table->header()->checksum_valid());
+    total_size = std::max<int64_t>(total_size, record->offset() +
+                                   ((record->length() + 3) & ~3));
+  }
+  if (total_size > std::numeric_limits<int32_t>::max())
+    return false;
+
+  output->assign(static_cast<size_t>(total_size), 0);
+  uint8_t* buffer = &((*output)[0]);
+
+  // Tables without contiguous data are copied here and now; the others are
+  // split into pieces that other threads may help copy.
+  std::vector<uint64_t> sums(tables.size(), 0);
+  std::vector<RegionCopy> copies;
+  int64_t copy_size = 0;
+  for (size_t i = 0; i < tables.size(); ++i) {
+    size_t num_copies = copies.size();
+    if (!AddTableRegion(tables[i], table_records[i], compute_checksums[i], i,
+                        buffer, &copies, &sums[i])) {
+      return false;
+    }
+    if (copies.size() > num_copies)
+      copy_size += table_records[i]->length();
+  }
+  std::shared_ptr<RegionCopier> copier =
+      std::make_shared<RegionCopier>(&copies);
+  if (task_runner && copy_size >= kMinParallelSerializeSize) {
+    size_t num_helpers = std::min(copier->copies().size() - 1,
+                                  kMaxSerializeHelpers);
+    for (size_t i = 0; i < num_helpers; ++i) {
+      if (!task_runner->TryPostTask([copier]() { copier->Run(); }))
+        break;
+    }
+  }
+  copier->Run();
+  copier->Wait();
+  for (size_t i = 0; i < copier->copies().size(); ++i) {
+    const RegionCopy& copy = copier->copies()[i];
+    sums[copy.table] += copy.sum;
+  }
+
+  // The head table's checkSumAdjustment is summed as zero and filled in last.
+  std::vector<int64_t> checksums(tables.size());
+  for (size_t i = 0; i < tables.size(); ++i) {
+    const HeaderPtr& record = table_records[i];
+    if (HasCheckSumAdjustment(record.p_)) {
+      uint8_t* adjustment = buffer + record->offset() +
+                            kHeadCheckSumAdjustmentOffset;
+      sums[i] -= GetULong(adjustment);
+      memset(adjustment, 0, 4);
+    }
+    checksums[i] = sums[i] & 0xffffffffL;
+  }
+
+  // Backpatch the directory with the computed checksums, then the head table
+  // with the checksum of the whole font.
+  const Header* head_record = NULL;
+  for (size_t i = 0; i < table_records.size(); ++i) {
+    HeaderPtr& record = table_records[i];
+    if (compute_checksums[i]) {
+      record = new Header(record->tag(), checksums[i], record->offset(),
+                          record->length());
+    }
+    if (HasCheckSumAdjustment(record.p_))
+      head_record = record.p_;
+  }
+  MemoryOutputStream directory_stream;
+  FontOutputStream directory_fos(&directory_stream);
+  SerializeHeader(&directory_fos, &table_records);
+  assert(directory_stream.Size() == header_stream.Size());
+  if (directory_stream.Size() > 0) {
+    std::copy(directory_stream.Get(),
+              directory_stream.Get() + directory_stream.Size(), buffer);
+  }
+  if (head_record) {
+    PutULong(buffer + head_record->offset() + kHeadCheckSumAdjustmentOffset,
+             ComputeCheckSumAdjustment(buffer, directory_stream.Size(),
+                                       table_records));
+  }
+  return true;
 }
 
 Font::Font(int32_t sfnt_version, std::vector<uint8_t>* digest)
@@ -95,7 +367,8 @@ Font::Font(int32_t sfnt_version, std::vector<uint8_t>* digest)
 }
 
 void Font::BuildTableHeadersForSerialization(std::vector<int32_t>* table_ordering,
-                                             TableHeaderList* table_headers) {
+                                             TableHeaderList* table_headers,
+                                             bool compute_checksums) {
   assert(table_headers);
   assert(table_ordering);
 
@@ -109,8 +382,14 @@ void Font::BuildTableHeadersForSerialization(std::vector<int32_t>* table_orderin
     if (table == NULL)
       continue;
 
-    HeaderPtr header = new Header(tag, table->CalculatedChecksum(),
-                                  table_offset, table->header()->length());
+    int64_t checksum = 0;
+    if (table->header()->checksum_valid()) {
+      checksum = table->header()->checksum();
+    } else if (compute_checksums) {
+      checksum = table->CalculatedChecksum();
+    }
+    HeaderPtr header = new Header(tag, checksum, table_offset,
+                                  table->header()->length());
     table_headers->push_back(header);
     table_offset += (table->DataLength() + 3) & ~3;
   }
@@ -142,7 +421,8 @@ void Font::SerializeHeader(FontOutputStream* fos,
 }
 
 void Font::SerializeTables(FontOutputStream* fos,
-                           TableHeaderList* table_headers) {
+                           TableHeaderList* table_headers,
+                           int64_t checksum_adjustment) {
   assert(fos);
   assert(table_headers);
   for (size_t i = 0; i < table_headers->size(); ++i) {
@@ -154,8 +434,19 @@ void Font::SerializeTables(FontOutputStream* fos,
 #endif
       return;
     }
-    int32_t table_size = target_table->Serialize(fos);
-    assert(table_size == record->length());
+    int32_t table_size;
+    if (HasCheckSumAdjustment(record.p_)) {
+      std::vector<uint8_t> head(record->length());
+      table_size = target_table->ReadFontData()->ReadBytes(0, &head[0], 0,
+                                                           head.size());
+      PutULong(&head[kHeadCheckSumAdjustmentOffset], checksum_adjustment);
+      fos->Write(&head, 0, table_size);
+    } else {
+      table_size = target_table->Serialize(fos);
+    }
+    // A table only comes up short once the output stream has failed, which
+    // the stream reports itself.
+    assert(table_size <= record->length());
 
     int32_t filler_size = ((table_size + 3) & ~3) - table_size;
     for (int32_t i = 0; i < filler_size; ++i) {
@@ -257,7 +548,9 @@ bool Font::Builder::ReadyToBuild() {
 
 CALLER_ATTACH Font* Font::Builder::Build() {
   FontPtr font = new Font(sfnt_version_, &digest_);
+  font->unloaded_table_headers_.swap(unloaded_table_headers_);
 
+  BuildAllTableBuilders();
   if (!table_builders_.empty()) {
     // Note: Different from Java. Directly use font->tables_ here to avoid
     //       STL container copying.
@@ -276,43 +569,87 @@ void Font::Builder::SetDigest(std::vector<uint8_t>* digest) {
 
 void Font::Builder::ClearTableBuilders() {
   table_builders_.clear();
+  pending_tables_.clear();
 }
 
 bool Font::Builder::HasTableBuilder(int32_t tag) {
-  return (table_builders_.find(tag) != table_builders_.end());
+  return (table_builders_.find(tag) != table_builders_.end() ||
+          pending_tables_.find(tag) != pending_tables_.end());
 }
 
 Table::Builder* Font::Builder::GetTableBuilder(int32_t tag) {
-  if (HasTableBuilder(tag))
-    return table_builders_[tag];
-  return NULL;
+  TableBuilderMap::iterator builder = table_builders_.find(tag);
+  if (builder != table_builders_.end())
+    return builder->second;
+  return BuildPendingTableBuilder(tag);
 }
 
 Table::Builder* Font::Builder::NewTableBuilder(int32_t tag) {
+  if (HasTableBuilder(tag))
+    return NULL;
   HeaderPtr header = new Header(tag);
   TableBuilderPtr builder;
   builder.Attach(Table::Builder::GetBuilder(header, NULL));
-  table_builders_.insert(TableBuilderEntry(header->tag(), builder));
-  return builder;
+  Table::Builder* builder_raw = builder;
+  table_builders_.insert(TableBuilderEntry(tag, std::move(builder)));
+  return builder_raw;
 }
 
 Table::Builder* Font::Builder::NewTableBuilder(int32_t tag,
                                                ReadableFontData* src_data) {
   assert(src_data);
+  if (HasTableBuilder(tag))
+    return NULL;
   WritableFontDataPtr data;
   data.Attach(WritableFontData::CreateWritableFontData(src_data->Length()));
   // TODO(stuarg): take over original data instead?
   src_data->CopyTo(data);
+  return NewTableBuilder(tag, std::move(data));
+}
 
+Table::Builder* Font::Builder::NewTableBuilder(int32_t tag,
+                                               Ptr<WritableFontData>&& data) {
+  assert(data);
+  if (HasTableBuilder(tag))
+    return NULL;
   HeaderPtr header = new Header(tag, data->Length());
   TableBuilderPtr builder;
   builder.Attach(Table::Builder::GetBuilder(header, data));
-  table_builders_.insert(TableBuilderEntry(tag, builder));
-  return builder;
+  Table::Builder* builder_raw = builder;
+  table_builders_.insert(TableBuilderEntry(tag, std::move(builder)));
+  data.Release();
+  return builder_raw;
+}
+
+Table::Builder* Font::Builder::NewTableBuilder(Table* src_table) {
+  assert(src_table);
+  Header* src_header = src_table->header();
+  if (HasTableBuilder(src_header->tag()))
+    return NULL;
+  ReadableFontData* data = src_table->ReadFontData();
+  HeaderPtr header;
+  if (src_header->checksum_valid()) {
+    header = new Header(src_header->tag(), src_header->checksum(), 0,
+                        data->Length());
+  } else {
+    header = new Header(src_header->tag(), data->Length());
+  }
+  TableBuilderPtr builder;
+  builder.Attach(Table::Builder::GetSharedBuilder(header, data));
+  Table::Builder* builder_raw = builder;
+  table_builders_.insert(TableBuilderEntry(header->tag(),
+                                           std::move(builder)));
+  return builder_raw;
+}
+
+TableBuilderMap* Font::Builder::table_builders() {
+  BuildAllTableBuilders();
+  return &table_builders_;
 }
 
 void Font::Builder::RemoveTableBuilder(int32_t tag) {
   table_builders_.erase(tag);
+  pending_tables_.erase(tag);
 }
 
 Font::Builder::Builder(FontFactory* factory)
@@ -327,7 +664,7 @@ void Font::Builder::LoadFont(InputStream* is) {
   HeaderOffsetSortedSet records;
   ReadHeader(&font_is, &records);
   LoadTableData(&records, &font_is, &data_blocks_);
-  BuildAllTableBuilders(&data_blocks_, &table_builders_);
+  DeferTableBuilders(&data_blocks_);
   font_is.Close();
 }
 
@@ -338,26 +675,63 @@ void Font::Builder::LoadFont(WritableFontData* wfd,
   HeaderOffsetSortedSet records;
   ReadHeader(wfd, offset_to_offset_table, &records);
   LoadTableData(&records, wfd, &data_blocks_);
-  BuildAllTableBuilders(&data_blocks_, &table_builders_);
+  DeferTableBuilders(&data_blocks_);
 }
 
 int32_t Font::Builder::SfntWrapperSize() {
   return Offset::kSfntHeaderSize +
-         (Offset::kTableRecordSize * table_builders_.size());
+         (Offset::kTableRecordSize * number_of_table_builders());
 }
 
-void Font::Builder::BuildAllTableBuilders(DataBlockMap* table_data,
-                                          TableBuilderMap* builder_map) {
+void Font::Builder::DeferTableBuilders(DataBlockMap* table_data) {
   for (DataBlockMap::iterator record = table_data->begin(),
                               record_end = table_data->end();
                               record != record_end; ++record) {
+    pending_tables_.insert(
+        std::make_pair(record->first->tag(), *record));
+  }
+}
+
+void Font::Builder::BuildAllTableBuilders() {
+  if (pending_tables_.empty())
+    return;
+
+  for (PendingTableMap::iterator pending = pending_tables_.begin(),
+                                 pending_end = pending_tables_.end();
+                                 pending != pending_end; ++pending) {
     TableBuilderPtr builder;
-    builder.Attach(GetTableBuilder(record->first.p_, record->second.p_));
-    builder_map->insert(TableBuilderEntry(record->first->tag(), builder));
+    builder.Attach(GetTableBuilder(pending->second.first,
+                                   pending->second.second));
+    table_builders_.insert(TableBuilderEntry(pending->first,
+                                             std::move(builder)));
   }
+  pending_tables_.clear();
   InterRelateBuilders(&table_builders_);
 }
 
+Table::Builder* Font::Builder::BuildPendingTableBuilder(int32_t tag) {
+  PendingTableMap::iterator pending = pending_tables_.find(tag);
+  if (pending == pending_tables_.end())
+    return NULL;
+
+  TableBuilderPtr builder;
+  builder.Attach(GetTableBuilder(pending->second.first,
+                                 pending->second.second));
+  Table::Builder* builder_raw = builder;
+  table_builders_.insert(TableBuilderEntry(tag, std::move(builder)));
+  pending_tables_.erase(pending);
+
+  // These builders take their glyph count and format from other tables, so
+  // bring those in before relating them.
+  if (tag == Tag::loca || tag == Tag::hmtx || tag == Tag::hdmx) {
+    BuildPendingTableBuilder(Tag::head);
+    BuildPendingTableBuilder(Tag::hhea);
+    BuildPendingTableBuilder(Tag::maxp);
+    InterRelateBuilders(&table_builders_);
+  }
+  return builder_raw;
+}
+
 CALLER_ATTACH
 Table::Builder* Font::Builder::GetTableBuilder(Header* header,
                                                WritableFontData* data) {
@@ -553,9 +927,14 @@ void Font::Builder::LoadTableData(HeaderOffsetSortedSet* headers,
                                        it != table_end;
                                        ++it) {
     const Ptr<Header> header = *it;
-    is->Skip(header->offset() - is->position());
     if (header->length() > kMaxTableSize)
       continue;
+    if (factory_ && !factory_->ShouldLoadTable(header->tag())) {
+      // Only the record is kept; the body is skipped over unread.
+      unloaded_table_headers_.push_back(header);
+      continue;
+    }
+    is->Skip(header->offset() - is->position());
 
     FontInputStream table_is(is, header->length());
     WritableFontDataPtr data;
@@ -575,6 +954,10 @@ void Font::Builder::LoadTableData(HeaderOffsetSortedSet* headers,
     const Ptr<Header> header = *it;
     if (header->length() > kMaxTableSize)
       continue;
+    if (factory_ && !factory_->ShouldLoadTable(header->tag())) {
+      unloaded_table_headers_.push_back(header);
+      continue;
+    }
 
     FontDataPtr sliced_data;
     sliced_data.Attach(fd->Slice(header->offset(), header->length()));
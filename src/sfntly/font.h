@@ -17,9 +17,11 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_FONT_H_
 #define SFNTLY_CPP_SRC_SFNTLY_FONT_H_
 
+#include <map>
 #include <vector>
 
 #include "sfntly/port/refcount.h"
+#include "sfntly/port/task_runner.h"
 #include "sfntly/port/type.h"
 #include "sfntly/port/endian.h"
 #include "sfntly/data/font_input_stream.h"
@@ -162,22 +164,40 @@ class Font : public RefCounted<Font> {
     Table::Builder* GetTableBuilder(int32_t tag);
 
     // Creates a new table builder for the table type given by the table id tag.
-    // This new table has been added to the font and will replace any existing
-    // builder for that table.
+    // This new table has been added to the font. An existing builder for that
+    // table, including one not created yet, is kept.
     // @return new empty table of the type specified by tag; if tag is not known
-    //         then a generic OpenTypeTable is returned
+    //         then a generic OpenTypeTable is returned; NULL if the font
+    //         builder already has a builder for the tag
     virtual Table::Builder* NewTableBuilder(int32_t tag);
 
     // Creates a new table builder for the table type given by the table id tag.
     // It makes a copy of the data provided and uses that copy for the table.
-    // This new table has been added to the font and will replace any existing
-    // builder for that table.
+    // This new table has been added to the font. An existing builder for that
+    // table is kept and NULL is returned instead.
     virtual Table::Builder* NewTableBuilder(int32_t tag,
                                             ReadableFontData* src_data);
 
+    // Creates a new table builder for the table type given by the table id tag
+    // that takes over the data provided instead of copying it. The caller
+    // must not modify the data afterwards.
+    // This new table has been added to the font. An existing builder for that
+    // table is kept, NULL is returned and the data is left with the caller.
+    virtual Table::Builder* NewTableBuilder(int32_t tag,
+                                            Ptr<WritableFontData>&& data);
+
+    // Creates a new table builder that shares an existing table's data rather
+    // than copying it; the data is copied only if the builder writes to it.
+    // The checksum recorded for the source table is carried over, so the table
+    // need not be checksummed again if it is serialized unmodified.
+    // This new table has been added to the font. An existing builder for that
+    // table is kept and NULL is returned instead.
+    virtual Table::Builder* NewTableBuilder(Table* src_table);
+
     // Get a map of the table builders in this font builder accessed by table
-    // tag.
-    virtual TableBuilderMap* table_builders() { return &table_builders_; }
+    // tag. Any table builders that have not been created yet are created
+    // first.
+    virtual TableBuilderMap* table_builders();
 
     // Remove the specified table builder from the font builder.
     // Note: different from Java: we don't return object in removeTableBuilder
@@ -185,7 +205,7 @@ class Font : public RefCounted<Font> {
 
     // Get the number of table builders in the font builder.
     virtual int32_t number_of_table_builders() {
-      return (int32_t)table_builders_.size();
+      return (int32_t)(table_builders_.size() + pending_tables_.size());
     }
 
    private:
@@ -194,8 +214,13 @@ class Font : public RefCounted<Font> {
     virtual void LoadFont(WritableFontData* wfd,
                           int32_t offset_to_offset_table);
     int32_t SfntWrapperSize();
-    void BuildAllTableBuilders(DataBlockMap* table_data,
-                               TableBuilderMap* builder_map);
+    // Tables read from a font keep only their raw data until their builder is
+    // first asked for; the typed builders are created on demand.
+    typedef std::map<int32_t, DataBlockEntry> PendingTableMap;
+
+    void DeferTableBuilders(DataBlockMap* table_data);
+    void BuildAllTableBuilders();
+    Table::Builder* BuildPendingTableBuilder(int32_t tag);
     CALLER_ATTACH Table::Builder*
         GetTableBuilder(Header* header, WritableFontData* data);
     void BuildTablesFromBuilders(Font* font,
@@ -219,6 +244,7 @@ class Font : public RefCounted<Font> {
                        DataBlockMap* table_data);
 
     TableBuilderMap table_builders_;
+    PendingTableMap pending_tables_;
     FontFactory* factory_;  // dumb pointer, avoid circular refcounting
     int32_t sfnt_version_;
     int32_t num_tables_;
@@ -226,6 +252,7 @@ class Font : public RefCounted<Font> {
     int32_t entry_selector_;
     int32_t range_shift_;
     DataBlockMap data_blocks_;
+    TableHeaderList unloaded_table_headers_;
     std::vector<uint8_t> digest_;
   };
 
@@ -260,13 +287,39 @@ class Font : public RefCounted<Font> {
   // Note: renamed tableMap() to GetTableMap()
   const TableMap* GetTableMap();
 
+  // Get the records of the tables in the font's directory that were skipped
+  // by the factory's table filter when the font was loaded. These tables are
+  // not part of the font and are not serialized.
+  const TableHeaderList* unloaded_table_headers() {
+    return &unloaded_table_headers_;
+  }
+
   // UNIMPLEMENTED: toString()
 
-  // Serialize the font to the output stream.
+  // Serialize the font to the output stream. The head table's
+  // checkSumAdjustment is recomputed for the serialized font.
   // @param os the destination for the font serialization
   // @param tableOrdering the table ordering to apply
   void Serialize(OutputStream* os, std::vector<int32_t>* table_ordering);
 
+  // Serialize the font into a buffer allocated once at the exact final size.
+  // Every table offset is known before any bytes are written, so each table
+  // is copied straight into its own region of the buffer in a single pass.
+  // Padding comes from the zero filled buffer. Checksums that cannot be
+  // reused are computed while each table is copied; the directory and
+  // head.checkSumAdjustment are then backpatched.
+  // The tables are copied in pieces. Once there is enough to copy, pieces are
+  // offered to the task runner and copied by whichever of its threads take
+  // them up, alongside the calling thread.
+  // @param output the destination; resized to the serialized font size
+  // @param tableOrdering the table ordering to apply
+  // @param task_runner threads that may help copy the tables; NULL to copy
+  //        them all on the calling thread
+  // @return true if every table was serialized in full
+  bool Serialize(std::vector<uint8_t>* output,
+                 std::vector<int32_t>* table_ordering,
+                 TaskRunner* task_runner);
+
  private:
   // Offsets to specific elements in the underlying data. These offsets are
   // relative to the start of the table or the start of sub-blocks within the
@@ -306,11 +359,17 @@ class Font : public RefCounted<Font> {
   // filled out with the data required for serialization. The headers will be
   // sorted in the order specified and only those specified will have headers
   // generated.
+  // Tables whose recorded checksum is still valid reuse it instead of having it
+  // recomputed.
   // @param tableOrdering the tables to generate headers for and the order to
   //        sort them
+  // @param compute_checksums whether to compute the checksums that could not
+  //        be reused; if false those headers carry a zero checksum that the
+  //        caller must replace
   // @return a list of table headers ready for serialization
   void BuildTableHeadersForSerialization(std::vector<int32_t>* table_ordering,
-                                         TableHeaderList* table_headers);
+                                         TableHeaderList* table_headers,
+                                         bool compute_checksums);
 
   // Searialize the headers.
   // @param fos the destination stream for the headers
@@ -321,8 +380,12 @@ class Font : public RefCounted<Font> {
   // Serialize the tables.
   // @param fos the destination stream for the headers
   // @param tableHeaders the headers for the tables to serialize
+  // @param checksum_adjustment the value written into the head table's
+  //        checkSumAdjustment field
   // @throws IOException
-  void SerializeTables(FontOutputStream* fos, TableHeaderList* table_headers);
+  void SerializeTables(FontOutputStream* fos,
+                       TableHeaderList* table_headers,
+                       int64_t checksum_adjustment);
 
   // Generate the full table ordering to used for serialization. The full
   // ordering uses the partial ordering as a seed and then adds all remaining
@@ -341,6 +404,7 @@ class Font : public RefCounted<Font> {
   std::vector<uint8_t> digest_;
   int64_t checksum_;
   TableMap tables_;
+  TableHeaderList unloaded_table_headers_;
 };
 typedef Ptr<Font> FontPtr;
 typedef std::vector<FontPtr> FontArray;
@@ -18,6 +18,7 @@
 
 #include <string.h>
 
+#include "sfntly/data/memory_byte_array.h"
 #include "sfntly/tag.h"
 
 namespace sfntly {
@@ -38,6 +39,21 @@ bool FontFactory::FingerprintFont() {
   return fingerprint_;
 }
 
+void FontFactory::SetTableFilter(const IntegerSet& tags, bool exclude) {
+  table_filter_ = tags;
+  table_filter_excludes_ = exclude;
+}
+
+void FontFactory::ClearTableFilter() {
+  table_filter_.clear();
+  table_filter_excludes_ = true;
+}
+
+bool FontFactory::ShouldLoadTable(int32_t tag) const {
+  bool listed = table_filter_.find(tag) != table_filter_.end();
+  return table_filter_excludes_ ? !listed : listed;
+}
+
 void FontFactory::LoadFonts(InputStream* is, FontArray* output) {
   assert(output);
   PushbackInputStream* pbis = down_cast<PushbackInputStream*>(is);
@@ -66,6 +82,21 @@ void FontFactory::LoadFonts(std::vector<uint8_t>* b, FontArray* output) {
   }
 }
 
+void FontFactory::LoadFonts(ByteArray* ba, FontArray* output) {
+  assert(ba);
+  assert(output);
+  WritableFontDataPtr wfd = new WritableFontData(ba);
+  if (IsCollection(wfd)) {
+    LoadCollection(wfd, output);
+    return;
+  }
+  FontPtr font;
+  font.Attach(LoadSingleOTF(wfd));
+  if (font) {
+    output->push_back(font);
+  }
+}
+
 void FontFactory::LoadFontsForBuilding(InputStream* is,
                                        FontBuilderArray* output) {
   PushbackInputStream* pbis = down_cast<PushbackInputStream*>(is);
@@ -95,11 +126,42 @@ void FontFactory::LoadFontsForBuilding(std::vector<uint8_t>* b,
   }
 }
 
+void FontFactory::LoadFontsForBuilding(ByteArray* ba,
+                                       FontBuilderArray* output) {
+  assert(ba);
+  assert(output);
+  // Builders may edit their table data in place, which a read-only array
+  // would silently drop.
+  ByteArrayPtr array = ba;
+  if (ba->read_only()) {
+    array = new MemoryByteArray(ba->Length());
+    if (ba->CopyTo(array) != ba->Length())
+      return;
+  }
+  WritableFontDataPtr wfd = new WritableFontData(array);
+  if (IsCollection(wfd)) {
+    LoadCollectionForBuilding(wfd, output);
+    return;
+  }
+  FontBuilderPtr builder;
+  builder.Attach(LoadSingleOTFForBuilding(wfd, 0));
+  if (builder) {
+    output->push_back(builder);
+  }
+}
+
 void FontFactory::SerializeFont(Font* font, OutputStream* os) {
   std::vector<int32_t> table_ordering;
   font->Serialize(os, &table_ordering);
 }
 
+bool FontFactory::SerializeFont(Font* font,
+                                std::vector<uint8_t>* output,
+                                TaskRunner* task_runner) {
+  std::vector<int32_t> table_ordering;
+  return font->Serialize(output, &table_ordering, task_runner);
+}
+
 CALLER_ATTACH Font::Builder* FontFactory::NewFontBuilder() {
   return Font::Builder::GetOTFBuilder(this);
 }
@@ -211,7 +273,8 @@ bool FontFactory::IsCollection(ReadableFontData* rfd) {
 }
 
 FontFactory::FontFactory()
-    : fingerprint_(false) {
+    : fingerprint_(false),
+      table_filter_excludes_(true) {
 }
 
 }  // namespace sfntly
@@ -41,6 +41,19 @@ class FontFactory : public RefCounted<FontFactory> {
   void FingerprintFont(bool fingerprint);
   bool FingerprintFont();
 
+  // Restrict which tables are read when fonts are loaded. If exclude is true
+  // the tables whose tags are in tags are skipped; otherwise only those tables
+  // are read. A skipped table is neither read nor copied, but its table record
+  // is kept in the font's unloaded_table_headers(). By default no table is
+  // skipped.
+  // @param tags the table tags to skip or to keep
+  // @param exclude whether tags lists the tables to skip
+  void SetTableFilter(const IntegerSet& tags, bool exclude);
+  void ClearTableFilter();
+
+  // @return true if the table with the given tag is read when loading
+  bool ShouldLoadTable(int32_t tag) const;
+
   // Load the font(s) from the input stream. The current settings on the factory
   // are used during the loading process. One or more fonts are returned if the
   // stream contains valid font data. Some font container formats may have more
@@ -58,6 +71,13 @@ class FontFactory : public RefCounted<FontFactory> {
   // will be returned.
   void LoadFonts(std::vector<uint8_t>* b, FontArray* output);
 
+  // Load the font(s) directly from an existing byte array without copying it.
+  // The tables of the returned fonts are slices of the array, so loading a
+  // MappedByteArray only touches the pages that are actually read. The array
+  // is kept alive by the fonts that reference it. If the data in the array
+  // cannot be parsed or is invalid an array of size zero will be returned.
+  void LoadFonts(ByteArray* ba, FontArray* output);
+
   // Load the font(s) from the input stream into font builders. The current
   // settings on the factory are used during the loading process. One or more
   // font builders are returned if the stream contains valid font data. Some
@@ -74,6 +94,12 @@ class FontFactory : public RefCounted<FontFactory> {
   // cannot be parsed or is invalid an array of size zero will be returned.
   void LoadFontsForBuilding(std::vector<uint8_t>* b, FontBuilderArray* output);
 
+  // Load the font(s) directly from an existing byte array into font builders
+  // without copying it. The builders' table data are slices of the array and
+  // may be edited in place, so a read-only array (e.g. a MappedByteArray) is
+  // copied into memory first.
+  void LoadFontsForBuilding(ByteArray* ba, FontBuilderArray* output);
+
   // Font serialization
   // Serialize the font to the output stream.
   // NOTE: in this port we attempted not to implement I/O stream because dealing
@@ -81,6 +107,13 @@ class FontFactory : public RefCounted<FontFactory> {
   //       Byte buffer it is.
   void SerializeFont(Font* font, OutputStream* os);
 
+  // Serialize the font into a buffer of exactly the serialized size.
+  // @param task_runner threads that may help copy the tables; may be NULL
+  // @return true on success
+  bool SerializeFont(Font* font,
+                     std::vector<uint8_t>* output,
+                     TaskRunner* task_runner);
+
   // Get an empty font builder for creating a new font from scratch.
   CALLER_ATTACH Font::Builder* NewFontBuilder();
 
@@ -125,6 +158,8 @@ class FontFactory : public RefCounted<FontFactory> {
   static bool IsCollection(ReadableFontData* wfd);
 
   bool fingerprint_;
+  IntegerSet table_filter_;
+  bool table_filter_excludes_;
 };
 typedef Ptr<FontFactory> FontFactoryPtr;
 
@@ -0,0 +1,170 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sfntly/math/font_checksum.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    (defined (__GNUC__) || defined (__clang__))
+#define SFNTLY_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+namespace sfntly {
+
+namespace {
+
+// Small enough to stay in L1 between the copy and the sum.
+const size_t kCopyChunkSize = 16 * 1024;
+
+typedef uint64_t (*SumKernel)(const uint8_t* data, size_t word_count);
+
+#if defined (SFNTLY_CHECKSUM_X86)
+
+// Instead of byte swapping every word, the vector kernels sum each of the four
+// byte lanes of the words separately with psadbw and weigh the lane sums by
+// their big endian position at the end.
+
+__attribute__((target("sse2")))
+uint64_t SumBigEndianWordsSSE2(const uint8_t* data, size_t word_count) {
+  const __m128i lane_mask = _mm_set1_epi32(0xff);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum3 = zero;  // lowest address byte of each word, weight 1 << 24
+  __m128i sum2 = zero;
+  __m128i sum1 = zero;
+  __m128i sum0 = zero;  // highest address byte of each word, weight 1
+  size_t blocks = word_count / 4;
+  for (size_t i = 0; i < blocks; ++i) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    sum3 = _mm_add_epi64(sum3, _mm_sad_epu8(_mm_and_si128(v, lane_mask), zero));
+    sum2 = _mm_add_epi64(sum2, _mm_sad_epu8(
+        _mm_and_si128(_mm_srli_epi32(v, 8), lane_mask), zero));
+    sum1 = _mm_add_epi64(sum1, _mm_sad_epu8(
+        _mm_and_si128(_mm_srli_epi32(v, 16), lane_mask), zero));
+    sum0 = _mm_add_epi64(sum0, _mm_sad_epu8(_mm_srli_epi32(v, 24), zero));
+    data += 16;
+  }
+  uint64_t lanes[4][2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[0]), sum3);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[1]), sum2);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[2]), sum1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[3]), sum0);
+  uint64_t sum = ((lanes[0][0] + lanes[0][1]) << 24) +
+                 ((lanes[1][0] + lanes[1][1]) << 16) +
+                 ((lanes[2][0] + lanes[2][1]) << 8) +
+                 (lanes[3][0] + lanes[3][1]);
+  return sum + FontChecksum::SumBigEndianWordsScalar(data, word_count % 4);
+}
+
+__attribute__((target("avx2")))
+uint64_t SumBigEndianWordsAVX2(const uint8_t* data, size_t word_count) {
+  const __m256i lane_mask = _mm256_set1_epi32(0xff);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i sum3 = zero;
+  __m256i sum2 = zero;
+  __m256i sum1 = zero;
+  __m256i sum0 = zero;
+  size_t blocks = word_count / 8;
+  for (size_t i = 0; i < blocks; ++i) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    sum3 = _mm256_add_epi64(sum3, _mm256_sad_epu8(
+        _mm256_and_si256(v, lane_mask), zero));
+    sum2 = _mm256_add_epi64(sum2, _mm256_sad_epu8(
+        _mm256_and_si256(_mm256_srli_epi32(v, 8), lane_mask), zero));
+    sum1 = _mm256_add_epi64(sum1, _mm256_sad_epu8(
+        _mm256_and_si256(_mm256_srli_epi32(v, 16), lane_mask), zero));
+    sum0 = _mm256_add_epi64(sum0, _mm256_sad_epu8(
+        _mm256_srli_epi32(v, 24), zero));
+    data += 32;
+  }
+  uint64_t lanes[4][4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[0]), sum3);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[1]), sum2);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[2]), sum1);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[3]), sum0);
+  uint64_t sum = 0;
+  for (int32_t i = 0; i < 4; ++i) {
+    uint64_t lane = lanes[i][0] + lanes[i][1] + lanes[i][2] + lanes[i][3];
+    sum += lane << (24 - 8 * i);
+  }
+  return sum + FontChecksum::SumBigEndianWordsScalar(data, word_count % 8);
+}
+
+SumKernel SelectKernel() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SumBigEndianWordsAVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SumBigEndianWordsSSE2;
+  return FontChecksum::SumBigEndianWordsScalar;
+}
+
+#else
+
+SumKernel SelectKernel() {
+  return FontChecksum::SumBigEndianWordsScalar;
+}
+
+#endif  // SFNTLY_CHECKSUM_X86
+
+}  // namespace
+
+// static
+uint64_t FontChecksum::SumBigEndianWords(const uint8_t* data,
+                                         size_t word_count) {
+  // Function local statics are initialized exactly once, even when first
+  // reached from several threads at the same time.
+  static const SumKernel kernel = SelectKernel();
+  return kernel(data, word_count);
+}
+
+// static
+uint64_t FontChecksum::CopyAndSumBigEndianWords(uint8_t* dst,
+                                                const uint8_t* src,
+                                                size_t length) {
+  uint64_t sum = 0;
+  size_t whole_words_length = length & ~static_cast<size_t>(3);
+  for (size_t offset = 0; offset < whole_words_length;
+       offset += kCopyChunkSize) {
+    size_t chunk = std::min(kCopyChunkSize, whole_words_length - offset);
+    memcpy(dst + offset, src + offset, chunk);
+    sum += SumBigEndianWords(dst + offset, chunk / 4);
+  }
+  if (whole_words_length < length) {
+    uint8_t last_word[4] = { 0, 0, 0, 0 };
+    memcpy(last_word, src + whole_words_length, length - whole_words_length);
+    memcpy(dst + whole_words_length, last_word, sizeof(last_word));
+    sum += SumBigEndianWordsScalar(last_word, 1);
+  }
+  return sum;
+}
+
+// static
+uint64_t FontChecksum::SumBigEndianWordsScalar(const uint8_t* data,
+                                               size_t word_count) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < word_count; ++i, data += 4) {
+    sum += (static_cast<uint32_t>(data[0]) << 24) |
+           (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) |
+           data[3];
+  }
+  return sum;
+}
+
+}  // namespace sfntly
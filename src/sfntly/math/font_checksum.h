@@ -0,0 +1,57 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_MATH_FONT_CHECKSUM_H_
+#define SFNTLY_CPP_SRC_SFNTLY_MATH_FONT_CHECKSUM_H_
+
+#include <stddef.h>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+class FontChecksum {
+ public:
+  // Sums a run of big endian 32-bit words, the core of the OpenType table
+  // checksum. The sum is not truncated to 32 bits. The kernel is picked once
+  // at runtime: AVX2 or SSE2 on x86 where the CPU supports it, portable C++
+  // everywhere else.
+  // @param data the first byte of the first word; need not be aligned
+  // @param word_count the number of 4-byte words to sum
+  // @return the sum of the words
+  static uint64_t SumBigEndianWords(const uint8_t* data, size_t word_count);
+
+  // Copies bytes and sums the big endian words of the copy in the same pass.
+  // The copy proceeds in cache sized chunks that are summed while still hot,
+  // so the source is only streamed through the cache once. A trailing partial
+  // word is padded with zeros, both in the sum and in dst.
+  // @param dst the destination; must have room for length rounded up to a
+  //        multiple of 4
+  // @param src the source bytes
+  // @param length the number of bytes to copy
+  // @return the sum of the words of the padded copy
+  static uint64_t CopyAndSumBigEndianWords(uint8_t* dst,
+                                           const uint8_t* src,
+                                           size_t length);
+
+  // The portable kernel, exposed for platforms without SIMD support and for
+  // cross checking the vector kernels.
+  static uint64_t SumBigEndianWordsScalar(const uint8_t* data,
+                                          size_t word_count);
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_MATH_FONT_CHECKSUM_H_
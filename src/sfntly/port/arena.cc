@@ -0,0 +1,153 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sfntly/port/arena.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "sfntly/port/atomic.h"
+
+namespace sfntly {
+
+namespace {
+
+// malloc'ed blocks already have this alignment; every allocation is rounded
+// up to it so that the cursor keeps it too.
+const size_t kAlignment = 16;
+
+// Requests larger than this fraction of a block get a block of their own so
+// that they do not waste the rest of the current one.
+const size_t kLargeAllocationDivisor = 4;
+
+thread_local Arena* g_current_arena = NULL;
+
+// Every ArenaAllocated allocation is preceded by the arena it came from (NULL
+// for the heap), padded to keep the object aligned.
+union AllocationPrefix {
+  Arena* arena;
+  uint8_t padding[kAlignment];
+};
+
+}  // namespace
+
+/******************************************************************************
+ * Arena class
+ ******************************************************************************/
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      bytes_reserved_(0),
+      cursor_(NULL),
+      limit_(NULL),
+      live_objects_(0) {
+}
+
+Arena::Arena()
+    : block_size_(kDefaultBlockSize),
+      bytes_reserved_(0),
+      cursor_(NULL),
+      limit_(NULL),
+      live_objects_(0) {
+}
+
+Arena::~Arena() {
+  assert(live_objects_ == 0);
+  if (live_objects_ != 0)
+    return;
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    free(blocks_[i]);
+  }
+}
+
+void* Arena::Allocate(size_t size) {
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  if (size > static_cast<size_t>(limit_ - cursor_)) {
+    if (size > block_size_ / kLargeAllocationDivisor)
+      return AllocateBlock(size);
+    uint8_t* block = static_cast<uint8_t*>(AllocateBlock(block_size_));
+    if (!block)
+      return NULL;
+    cursor_ = block;
+    limit_ = block + block_size_;
+  }
+  void* p = cursor_;
+  cursor_ += size;
+  return p;
+}
+
+// static
+Arena* Arena::Current() {
+  return g_current_arena;
+}
+
+void* Arena::AllocateBlock(size_t size) {
+  uint8_t* block = static_cast<uint8_t*>(malloc(size));
+  if (!block)
+    return NULL;
+  blocks_.push_back(block);
+  bytes_reserved_ += size;
+  return block;
+}
+
+/******************************************************************************
+ * ArenaScope class
+ ******************************************************************************/
+ArenaScope::ArenaScope(Arena* arena) : previous_(g_current_arena) {
+  g_current_arena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+  g_current_arena = previous_;
+}
+
+/******************************************************************************
+ * ArenaAllocated class
+ ******************************************************************************/
+// static
+void* ArenaAllocated::operator new(size_t size) {
+  return Allocate(size);
+}
+
+// static
+void ArenaAllocated::operator delete(void* p) {
+  Deallocate(p);
+}
+
+// static
+void* ArenaAllocated::Allocate(size_t size) {
+  Arena* arena = g_current_arena;
+  size += sizeof(AllocationPrefix);
+  AllocationPrefix* prefix = static_cast<AllocationPrefix*>(
+      arena ? arena->Allocate(size) : malloc(size));
+  if (!prefix)
+    return NULL;
+  prefix->arena = arena;
+  if (arena)
+    AtomicIncrement(&arena->live_objects_);
+  return prefix + 1;
+}
+
+// static
+void ArenaAllocated::Deallocate(void* p) {
+  if (!p)
+    return;
+  AllocationPrefix* prefix = static_cast<AllocationPrefix*>(p) - 1;
+  if (prefix->arena)
+    AtomicDecrement(&prefix->arena->live_objects_);
+  else
+    free(prefix);
+}
+
+}  // namespace sfntly
@@ -0,0 +1,152 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
+
+#include <stddef.h>
+
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "sfntly/port/type.h"
+
+namespace sfntly {
+
+// A monotonic allocator for the objects of one job, e.g. a single subset
+// request. Memory is carved sequentially out of large blocks and only handed
+// back to the system when the arena itself is destroyed, so thousands of small
+// objects cost a pointer bump each and are freed together.
+//
+// An arena is filled from one thread, the one on which it is installed with an
+// ArenaScope. Objects placed in it may be released from any thread. Everything
+// allocated from an arena must be gone before the arena is destroyed; should
+// objects still be alive at that point the blocks are leaked rather than
+// freed (and debug builds assert).
+class Arena {
+ public:
+  static const size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit Arena(size_t block_size);
+  Arena();
+  ~Arena();
+
+  // Allocate memory aligned for any fundamental type. Never returns memory to
+  // the arena before it is destroyed.
+  // @param size the number of bytes to allocate
+  // @return the memory; NULL if the system is out of memory
+  void* Allocate(size_t size);
+
+  // @return the total size of the blocks obtained from the system
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+  // @return the arena installed on the calling thread; NULL if none
+  static Arena* Current();
+
+ private:
+  friend class ArenaScope;
+  friend class ArenaAllocated;
+
+  void* AllocateBlock(size_t size);
+
+  size_t block_size_;
+  size_t bytes_reserved_;
+  uint8_t* cursor_;
+  uint8_t* limit_;
+  std::vector<uint8_t*> blocks_;
+  // Number of ArenaAllocated objects placed in the arena and not yet deleted.
+  size_t live_objects_;
+
+  NO_COPY_AND_ASSIGN(Arena);
+};
+
+// Installs an arena as the current one on the calling thread for as long as
+// the ArenaScope is in scope. Scopes nest; the previous arena is restored on
+// exit.
+class ArenaScope {
+ public:
+  explicit ArenaScope(Arena* arena);
+  ~ArenaScope();
+
+ private:
+  Arena* previous_;
+
+  NO_COPY_AND_ASSIGN(ArenaScope);
+};
+
+// Base class for objects that are placed in the current thread's arena when
+// one is installed and on the heap otherwise. Each allocation records where it
+// came from, so objects can be released through the usual ref counting no
+// matter which thread drops the last reference.
+class ArenaAllocated {
+ public:
+  static void* operator new(size_t size);
+  static void operator delete(void* p);
+
+  // Allocate and free raw storage the same way objects are; used for buffers
+  // owned by arena allocated objects.
+  static void* Allocate(size_t size);
+  static void Deallocate(void* p);
+};
+
+// STL allocator drawing from the arena that was current when it was
+// constructed, or from the heap if there was none. Deallocation is a no-op
+// for arena memory, which makes node based containers built during a job
+// essentially free to tear down.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  // Containers moved or swapped take the source's arena along, so that a move
+  // is a pointer steal even between containers built in different arenas.
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ArenaAllocator() : arena_(Arena::Current()) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    return static_cast<T*>(arena_ ? arena_->Allocate(size) :
+                                    ::operator new(size));
+  }
+
+  void deallocate(T* p, size_t n) {
+    UNREFERENCED_PARAMETER(n);
+    if (!arena_)
+      ::operator delete(p);
+  }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() != b.arena();
+}
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_ARENA_H_
@@ -44,6 +44,22 @@ static inline uint64_t EndianSwap64(uint64_t value) {
           ((value & 0xff00000000000000LL) >> 56));
 }
 
+// Swap the byte order of a run of values in place. The loops are kept free of
+// branches and aliasing so that the compiler can vectorize them.
+static inline void EndianSwap16Array(uint16_t* values, int32_t count) {
+  for (int32_t i = 0; i < count; ++i) {
+    values[i] = (uint16_t)((values[i] >> 8) | (values[i] << 8));
+  }
+}
+
+static inline void EndianSwap32Array(uint32_t* values, int32_t count) {
+  for (int32_t i = 0; i < count; ++i) {
+    uint32_t v = values[i];
+    values[i] = (v << 24) | ((v & 0x0000ff00) << 8) |
+                ((v & 0x00ff0000) >> 8) | (v >> 24);
+  }
+}
+
 #ifdef SFNTLY_LITTLE_ENDIAN
   #define ToBE16(n) EndianSwap16(n)
   #define ToBE32(n) EndianSwap32(n)
@@ -57,6 +73,10 @@ static inline uint64_t EndianSwap64(uint64_t value) {
   #define FromLE16(n) (n)
   #define FromLE32(n) (n)
   #define FromLE64(n) (n)
+  #define FromBE16Array(v, n) EndianSwap16Array(v, n)
+  #define FromBE32Array(v, n) EndianSwap32Array(v, n)
+  #define ToBE16Array(v, n) EndianSwap16Array(v, n)
+  #define ToBE32Array(v, n) EndianSwap32Array(v, n)
 #else  // SFNTLY_BIG_ENDIAN
   #define ToBE16(n) (n)
   #define ToBE32(n) (n)
@@ -70,6 +90,10 @@ static inline uint64_t EndianSwap64(uint64_t value) {
   #define FromLE16(n) EndianSwap16(n)
   #define FromLE32(n) EndianSwap32(n)
   #define FromLE64(n) EndianSwap64(n)
+  #define FromBE16Array(v, n)
+  #define FromBE32Array(v, n)
+  #define ToBE16Array(v, n)
+  #define ToBE32Array(v, n)
 #endif
 
 }  // namespace sfntly
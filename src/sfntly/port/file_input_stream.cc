@@ -107,6 +107,22 @@ int32_t FileInputStream::Read(std::vector<uint8_t>* b, int32_t offset, int32_t l
   return actual_read;
 }
 
+int32_t FileInputStream::Read(uint8_t* b, int32_t offset, int32_t length) {
+  assert(b);
+  if (!file_) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  if (offset < 0 || length <= 0 || position_ >= length_)
+    return 0;
+  size_t read_count = std::min<size_t>(length_ - position_, length);
+  int32_t actual_read = fread(b + offset, 1, read_count, file_);
+  position_ += actual_read;
+  return actual_read;
+}
+
 void FileInputStream::Reset() {
   // NOP
 }
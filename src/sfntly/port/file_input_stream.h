@@ -37,6 +37,7 @@ class FileInputStream : public PushbackInputStream {
   virtual int32_t Read();
   virtual int32_t Read(std::vector<uint8_t>* b);
   virtual int32_t Read(std::vector<uint8_t>* b, int32_t offset, int32_t length);
+  virtual int32_t Read(uint8_t* b, int32_t offset, int32_t length);
   virtual void Reset();
   virtual int64_t Skip(int64_t n);
 
@@ -0,0 +1,287 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sfntly/port/file_output_stream.h"
+
+#if defined (WIN32)
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#if defined (__linux__)
+#include <sys/sendfile.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "sfntly/port/exception_type.h"
+
+namespace sfntly {
+
+const size_t FileOutputStream::kDefaultBufferSize = 64 * 1024;
+
+namespace {
+
+// Writes all of the given chunks, retrying on short writes and EINTR.
+bool WriteAll(int fd, const uint8_t* first, size_t first_length,
+              const uint8_t* second, size_t second_length) {
+#if defined (WIN32)
+  const uint8_t* chunks[2] = { first, second };
+  size_t lengths[2] = { first_length, second_length };
+  for (int i = 0; i < 2; ++i) {
+    while (lengths[i] > 0) {
+      int written = _write(fd, chunks[i], (unsigned int)lengths[i]);
+      if (written <= 0)
+        return false;
+      chunks[i] += written;
+      lengths[i] -= written;
+    }
+  }
+  return true;
+#else
+  struct iovec iov[2];
+  iov[0].iov_base = const_cast<uint8_t*>(first);
+  iov[0].iov_len = first_length;
+  iov[1].iov_base = const_cast<uint8_t*>(second);
+  iov[1].iov_len = second_length;
+  struct iovec* pending = iov;
+  int count = 2;
+  while (count > 0) {
+    if (pending->iov_len == 0) {
+      ++pending;
+      --count;
+      continue;
+    }
+    ssize_t written = writev(fd, pending, count);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    while (count > 0 && static_cast<size_t>(written) >= pending->iov_len) {
+      written -= pending->iov_len;
+      ++pending;
+      --count;
+    }
+    if (count > 0) {
+      pending->iov_base = static_cast<uint8_t*>(pending->iov_base) + written;
+      pending->iov_len -= written;
+    }
+  }
+  return true;
+#endif
+}
+
+}  // namespace
+
+FileOutputStream::FileOutputStream()
+    : fd_(-1),
+      owns_fd_(false),
+      error_(false),
+      kernel_copy_(true),
+      position_(0),
+      buffer_(kDefaultBufferSize),
+      buffered_(0) {
+}
+
+FileOutputStream::FileOutputStream(size_t buffer_size)
+    : fd_(-1),
+      owns_fd_(false),
+      error_(false),
+      kernel_copy_(true),
+      position_(0),
+      buffer_(buffer_size > 0 ? buffer_size : 1),
+      buffered_(0) {
+}
+
+FileOutputStream::~FileOutputStream() {
+  Close();
+}
+
+bool FileOutputStream::Open(const char* file_path) {
+  Close();
+  if (!file_path)
+    return false;
+#if defined (WIN32)
+  int fd = _open(file_path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  if (fd < 0)
+    return false;
+  fd_ = fd;
+  owns_fd_ = true;
+  error_ = false;
+  position_ = 0;
+  return true;
+}
+
+bool FileOutputStream::Attach(int fd) {
+  Close();
+  if (fd < 0)
+    return false;
+  fd_ = fd;
+  owns_fd_ = false;
+  error_ = false;
+  position_ = 0;
+  return true;
+}
+
+void FileOutputStream::Close() {
+  if (fd_ < 0)
+    return;
+  Flush();
+  if (owns_fd_) {
+#if defined (WIN32)
+    if (_close(fd_) != 0)
+#else
+    if (close(fd_) != 0)
+#endif
+      error_ = true;
+  }
+  fd_ = -1;
+  owns_fd_ = false;
+}
+
+void FileOutputStream::Flush() {
+  WriteThrough(NULL, 0);
+}
+
+void FileOutputStream::Write(std::vector<uint8_t>* buffer) {
+  assert(buffer);
+  if (!buffer->empty())
+    Write(&((*buffer)[0]), 0, buffer->size());
+}
+
+void FileOutputStream::Write(std::vector<uint8_t>* buffer,
+                             int32_t offset,
+                             int32_t length) {
+  assert(buffer);
+  if (offset >= 0 && length > 0 &&
+      static_cast<size_t>(offset) + length <= buffer->size()) {
+    Write(&((*buffer)[0]), offset, length);
+  } else {
+#if !defined(SFNTLY_NO_EXCEPTION)
+    throw IndexOutOfBoundException();
+#endif
+  }
+}
+
+void FileOutputStream::Write(uint8_t* buffer, int32_t offset, int32_t length) {
+  assert(buffer);
+  if (offset < 0 || length <= 0) {
+#if !defined(SFNTLY_NO_EXCEPTION)
+    throw IndexOutOfBoundException();
+#endif
+    return;
+  }
+  position_ += length;
+  size_t size = static_cast<size_t>(length);
+  if (size >= buffer_.size() / 2) {
+    // Large chunk: send it together with the buffered bytes, no copy.
+    WriteThrough(buffer + offset, size);
+    return;
+  }
+  if (buffered_ + size > buffer_.size())
+    WriteThrough(NULL, 0);
+  memcpy(&(buffer_[buffered_]), buffer + offset, size);
+  buffered_ += size;
+}
+
+void FileOutputStream::Write(uint8_t b) {
+  if (buffered_ == buffer_.size())
+    WriteThrough(NULL, 0);
+  buffer_[buffered_++] = b;
+  position_++;
+}
+
+int32_t FileOutputStream::WriteFileRange(int fd,
+                                         int64_t offset,
+                                         int32_t length) {
+#if defined (__linux__)
+  if (fd_ < 0 || error_ || !kernel_copy_ || fd < 0 || offset < 0 ||
+      length <= 0) {
+    return 0;
+  }
+  // The kernel writes at the descriptor's file offset, behind anything that
+  // is still buffered.
+  Flush();
+  if (error_)
+    return 0;
+
+  loff_t in_offset = offset;
+  int32_t copied = 0;
+  bool use_sendfile = false;
+  while (copied < length) {
+    size_t remaining = static_cast<size_t>(length - copied);
+    ssize_t result;
+    if (!use_sendfile) {
+      result = copy_file_range(fd, &in_offset, fd_, NULL, remaining, 0);
+    } else {
+      off_t sendfile_offset = static_cast<off_t>(in_offset);
+      result = sendfile(fd_, fd, &sendfile_offset, remaining);
+      if (result > 0)
+        in_offset = sendfile_offset;
+    }
+    if (result > 0) {
+      copied += static_cast<int32_t>(result);
+      continue;
+    }
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result < 0 && (errno == EXDEV || errno == EINVAL ||
+                       errno == ENOSYS || errno == EOPNOTSUPP ||
+                       errno == EBADF)) {
+      // Not supported between these two files.
+      if (!use_sendfile) {
+        use_sendfile = true;
+        continue;
+      }
+      kernel_copy_ = false;
+      break;
+    }
+    if (result < 0) {
+      error_ = true;
+      position_ += copied;
+      return -1;
+    }
+    // A short source ends the copy; the caller writes what is left.
+    break;
+  }
+  position_ += copied;
+  return copied;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(length);
+  return 0;
+#endif
+}
+
+void FileOutputStream::WriteThrough(const uint8_t* b, size_t length) {
+  if (buffered_ == 0 && length == 0)
+    return;
+  if (fd_ < 0 || error_ ||
+      !WriteAll(fd_, &(buffer_[0]), buffered_, b, length)) {
+    error_ = true;
+  }
+  buffered_ = 0;
+}
+
+}  // namespace sfntly
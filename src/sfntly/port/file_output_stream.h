@@ -0,0 +1,85 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_FILE_OUTPUT_STREAM_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_FILE_OUTPUT_STREAM_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "sfntly/port/type.h"
+#include "sfntly/port/output_stream.h"
+
+namespace sfntly {
+
+// OutputStream backed by a file descriptor, e.g. a file opened by Open(), or
+// stdout or a pipe handed to Attach(). Small writes are gathered in a buffer;
+// writes of at least half the buffer go out together with whatever is
+// buffered in a single writev() instead of being copied first.
+// Errors are sticky: once a write fails the stream drops all further output
+// and error() returns true.
+class FileOutputStream : public OutputStream {
+ public:
+  static const size_t kDefaultBufferSize;
+
+  FileOutputStream();
+  explicit FileOutputStream(size_t buffer_size);
+  virtual ~FileOutputStream();
+
+  // Creates or truncates the file at file_path and writes to it. The
+  // descriptor is closed by Close().
+  // @return false if the file could not be opened
+  virtual bool Open(const char* file_path);
+
+  // Writes to an already open descriptor. The descriptor is not closed by
+  // Close(); only pending output is flushed.
+  // @return false if fd is not a valid descriptor
+  virtual bool Attach(int fd);
+
+  virtual void Close();
+  virtual void Flush();
+  virtual void Write(std::vector<uint8_t>* buffer);
+  virtual void Write(std::vector<uint8_t>* buffer, int32_t offset, int32_t length);
+  virtual void Write(uint8_t* buffer, int32_t offset, int32_t length);
+  virtual void Write(uint8_t b);
+
+  // Copies the range with copy_file_range(), or sendfile() where that is not
+  // supported between the two files. If neither works the stream stops
+  // trying and leaves the copy to the caller.
+  virtual int32_t WriteFileRange(int fd, int64_t offset, int32_t length);
+
+  // @return true if any write to the descriptor has failed
+  bool error() const { return error_; }
+
+  // @return the total number of bytes accepted by the stream so far
+  int64_t position() const { return position_; }
+
+ private:
+  // Writes the buffered bytes followed by length bytes of b to the descriptor
+  // and empties the buffer.
+  void WriteThrough(const uint8_t* b, size_t length);
+
+  int fd_;
+  bool owns_fd_;
+  bool error_;
+  bool kernel_copy_;
+  int64_t position_;
+  std::vector<uint8_t> buffer_;
+  size_t buffered_;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_FILE_OUTPUT_STREAM_H_
@@ -32,6 +32,8 @@ class InputStream {
   virtual int32_t Read() = 0;
   virtual int32_t Read(std::vector<uint8_t>* b) = 0;
   virtual int32_t Read(std::vector<uint8_t>* b, int32_t offset, int32_t length) = 0;
+  // Note: Caller is responsible for the boundary of b.
+  virtual int32_t Read(uint8_t* b, int32_t offset, int32_t length) = 0;
   virtual void Reset() = 0;
   virtual int64_t Skip(int64_t n) = 0;
 
@@ -25,7 +25,7 @@
 namespace sfntly {
 
 template <typename ReturnType, typename ContainerBase>
-class Iterator : public virtual RefCount {
+class Iterator : public RefCount {
  public:
   virtual ~Iterator() {}
   virtual ContainerBase* container_base() = 0;
@@ -37,8 +37,7 @@ class Iterator : public virtual RefCount {
 
 template <typename ReturnType, typename Container,
           typename ContainerBase = Container>
-class PODIterator : public Iterator<ReturnType, ContainerBase>,
-                    public RefCounted< PODIterator<ReturnType, Container> > {
+class PODIterator : public Iterator<ReturnType, ContainerBase> {
  public:
   explicit PODIterator(Container* container) : container_(container) {}
   virtual ~PODIterator() {}
@@ -64,8 +63,7 @@ class PODIterator : public Iterator<ReturnType, ContainerBase>,
 
 template <typename ReturnType, typename Container,
           typename ContainerBase = Container>
-class RefIterator : public Iterator<ReturnType, ContainerBase>,
-                    public RefCounted< RefIterator<ReturnType, Container> > {
+class RefIterator : public Iterator<ReturnType, ContainerBase> {
  public:
   explicit RefIterator(Container* container) : container_(container) {}
   virtual ~RefIterator() {}
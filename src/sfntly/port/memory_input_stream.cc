@@ -101,6 +101,22 @@ int32_t MemoryInputStream::Read(std::vector<uint8_t>* b, int32_t offset, int32_t
   return read_count;
 }
 
+int32_t MemoryInputStream::Read(uint8_t* b, int32_t offset, int32_t length) {
+  assert(b);
+  if (!buffer_) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no memory attached");
+#endif
+    return 0;
+  }
+  if (offset < 0 || length <= 0 || position_ >= length_)
+    return 0;
+  size_t read_count = std::min<size_t>(length_ - position_, length);
+  memcpy(b + offset, buffer_ + position_, read_count);
+  position_ += read_count;
+  return read_count;
+}
+
 void MemoryInputStream::Reset() {
   // NOP
 }
@@ -39,6 +39,22 @@ class OutputStream {
 
   // Note: Caller is responsible for the boundary of buffer.
   virtual void Write(uint8_t* buffer, int32_t offset, int32_t length) = 0;
+
+  // Copies a range of an open file to the stream inside the kernel, without
+  // passing the bytes through user space. Only streams backed by a file
+  // descriptor can do this; the default copies nothing. The caller writes
+  // whatever was not copied itself.
+  // @param fd the descriptor of the source file
+  // @param offset the start of the range in the source file
+  // @param length the length of the range
+  // @return the number of bytes copied; -1 if writing to the stream failed,
+  //         after which the stream accepts no more output
+  virtual int32_t WriteFileRange(int fd, int64_t offset, int32_t length) {
+    UNREFERENCED_PARAMETER(fd);
+    UNREFERENCED_PARAMETER(offset);
+    UNREFERENCED_PARAMETER(length);
+    return 0;
+  }
 };
 
 }  // namespace sfntly
@@ -0,0 +1,266 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sfntly/port/random_access_file_input_stream.h"
+
+#if defined (WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "sfntly/port/exception_type.h"
+
+namespace sfntly {
+
+const size_t RandomAccessFileInputStream::kDefaultBufferSize = 64 * 1024;
+
+RandomAccessFileInputStream::RandomAccessFileInputStream()
+    : fd_(-1),
+      position_(0),
+      length_(0),
+      mark_(0),
+      buffer_(kDefaultBufferSize),
+      buffer_start_(0),
+      buffer_end_(0) {
+}
+
+RandomAccessFileInputStream::RandomAccessFileInputStream(size_t buffer_size)
+    : fd_(-1),
+      position_(0),
+      length_(0),
+      mark_(0),
+      buffer_(buffer_size > 0 ? buffer_size : 1),
+      buffer_start_(0),
+      buffer_end_(0) {
+}
+
+RandomAccessFileInputStream::~RandomAccessFileInputStream() {
+  Close();
+}
+
+int32_t RandomAccessFileInputStream::Length() {
+  return (int32_t)std::min<int64_t>(length_, 0x7fffffff);
+}
+
+int32_t RandomAccessFileInputStream::Available() {
+  return (int32_t)std::min<int64_t>(length_ - position_, 0x7fffffff);
+}
+
+void RandomAccessFileInputStream::Close() {
+  if (fd_ >= 0) {
+#if defined (WIN32)
+    _close(fd_);
+#else
+    close(fd_);
+#endif
+  }
+  fd_ = -1;
+  position_ = 0;
+  length_ = 0;
+  mark_ = 0;
+  buffer_start_ = 0;
+  buffer_end_ = 0;
+}
+
+void RandomAccessFileInputStream::Mark(int32_t readlimit) {
+  // Any position can be returned to, so the limit does not matter.
+  UNREFERENCED_PARAMETER(readlimit);
+  mark_ = position_;
+}
+
+bool RandomAccessFileInputStream::MarkSupported() {
+  return true;
+}
+
+int32_t RandomAccessFileInputStream::Read() {
+  if (fd_ < 0) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return -1;
+  }
+  if (position_ < buffer_start_ || position_ >= buffer_end_) {
+    if (!Fill()) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+      throw IOException("eof reached");
+#endif
+      return -1;
+    }
+  }
+  return buffer_[(size_t)(position_++ - buffer_start_)];
+}
+
+int32_t RandomAccessFileInputStream::Read(std::vector<uint8_t>* b) {
+  return Read(b, 0, b->size());
+}
+
+int32_t RandomAccessFileInputStream::Read(std::vector<uint8_t>* b,
+                                          int32_t offset,
+                                          int32_t length) {
+  assert(b);
+  if (offset < 0 || length < 0) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IndexOutOfBoundException();
+#endif
+    return 0;
+  }
+  int32_t read_count =
+      (int32_t)std::min<int64_t>(std::max<int64_t>(length_ - position_, 0),
+                                 length);
+  if (read_count == 0)
+    return 0;
+  if (b->size() < (size_t)(offset + read_count)) {
+    b->resize((size_t)(offset + read_count));
+  }
+  return Read(&((*b)[0]), offset, read_count);
+}
+
+int32_t RandomAccessFileInputStream::Read(uint8_t* b,
+                                          int32_t offset,
+                                          int32_t length) {
+  assert(b);
+  if (fd_ < 0) {
+#if !defined (SFNTLY_NO_EXCEPTION)
+    throw IOException("no opened file");
+#endif
+    return 0;
+  }
+  if (offset < 0 || length <= 0)
+    return 0;
+
+  int32_t total = 0;
+  while (total < length && position_ < length_) {
+    if (position_ >= buffer_start_ && position_ < buffer_end_) {
+      int32_t count = (int32_t)std::min<int64_t>(buffer_end_ - position_,
+                                                 length - total);
+      memcpy(b + offset + total,
+             &(buffer_[(size_t)(position_ - buffer_start_)]), count);
+      position_ += count;
+      total += count;
+    } else if ((size_t)(length - total) >= buffer_.size()) {
+      // Too large to be worth buffering: read straight into the caller's
+      // memory.
+      int64_t count = ReadAt(position_, b + offset + total, length - total);
+      if (count <= 0)
+        break;
+      position_ += count;
+      total += (int32_t)count;
+    } else if (!Fill()) {
+      break;
+    }
+  }
+  return total;
+}
+
+void RandomAccessFileInputStream::Reset() {
+  position_ = mark_;
+}
+
+int64_t RandomAccessFileInputStream::Skip(int64_t n) {
+  int64_t old_position = position_;
+  Seek(position_ + n);
+  return position_ - old_position;
+}
+
+void RandomAccessFileInputStream::Unread(std::vector<uint8_t>* b) {
+  Unread(b, 0, b->size());
+}
+
+void RandomAccessFileInputStream::Unread(std::vector<uint8_t>* b,
+                                         int32_t offset,
+                                         int32_t length) {
+  assert(b);
+  assert(b->size() >= size_t(offset + length));
+  UNREFERENCED_PARAMETER(b);
+  UNREFERENCED_PARAMETER(offset);
+  Seek(position_ - length);
+}
+
+bool RandomAccessFileInputStream::Open(const char* file_path) {
+  assert(file_path);
+  Close();
+#if defined (WIN32)
+  int fd = _open(file_path, _O_RDONLY | _O_BINARY);
+#else
+  int fd = open(file_path, O_RDONLY | O_CLOEXEC);
+#endif
+  if (fd < 0)
+    return false;
+#if defined (WIN32)
+  struct _stat64 st;
+  if (_fstat64(fd, &st) != 0) {
+    _close(fd);
+    return false;
+  }
+#else
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+#endif
+  fd_ = fd;
+  length_ = st.st_size;
+  return true;
+}
+
+void RandomAccessFileInputStream::Seek(int64_t position) {
+  position_ = std::max<int64_t>(0, std::min<int64_t>(position, length_));
+}
+
+bool RandomAccessFileInputStream::Fill() {
+  if (position_ >= length_)
+    return false;
+  int64_t count = ReadAt(position_, &(buffer_[0]), buffer_.size());
+  if (count <= 0) {
+    buffer_start_ = buffer_end_ = 0;
+    return false;
+  }
+  buffer_start_ = position_;
+  buffer_end_ = position_ + count;
+  return true;
+}
+
+int64_t RandomAccessFileInputStream::ReadAt(int64_t offset,
+                                            uint8_t* b,
+                                            int64_t length) {
+  int64_t total = 0;
+  while (total < length) {
+#if defined (WIN32)
+    if (_lseeki64(fd_, offset + total, SEEK_SET) < 0)
+      break;
+    int result = _read(fd_, b + total,
+                       (unsigned int)std::min<int64_t>(length - total,
+                                                       0x7fffffff));
+#else
+    ssize_t result = pread(fd_, b + total, (size_t)(length - total),
+                           (off_t)(offset + total));
+#endif
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      break;
+    total += result;
+  }
+  return total;
+}
+
+}  // namespace sfntly
@@ -0,0 +1,89 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "sfntly/port/type.h"
+#include "sfntly/port/input_stream.h"
+
+namespace sfntly {
+
+// PushbackInputStream over a file read with pread() at 64-bit offsets. Reads
+// are served from a read-ahead buffer, so parsing the table directory a few
+// bytes at a time costs no system call per value. Reads at least as large as
+// the buffer go straight into the caller's memory. Skip() and Unread() only
+// move the position; the next read past the buffer fetches from there.
+// Unread() assumes the bytes were just read from this stream: it rewinds over
+// them rather than storing them.
+class RandomAccessFileInputStream : public PushbackInputStream {
+ public:
+  static const size_t kDefaultBufferSize;
+
+  RandomAccessFileInputStream();
+  explicit RandomAccessFileInputStream(size_t buffer_size);
+  virtual ~RandomAccessFileInputStream();
+
+  // InputStream methods
+  virtual int32_t Length();
+  virtual int32_t Available();
+  virtual void Close();
+  virtual void Mark(int32_t readlimit);
+  virtual bool MarkSupported();
+  virtual int32_t Read();
+  virtual int32_t Read(std::vector<uint8_t>* b);
+  virtual int32_t Read(std::vector<uint8_t>* b, int32_t offset, int32_t length);
+  virtual int32_t Read(uint8_t* b, int32_t offset, int32_t length);
+  virtual void Reset();
+  virtual int64_t Skip(int64_t n);
+
+  // PushbackInputStream methods
+  virtual void Unread(std::vector<uint8_t>* b);
+  virtual void Unread(std::vector<uint8_t>* b, int32_t offset, int32_t length);
+
+  // Own methods
+  virtual bool Open(const char* file_path);
+
+  // Moves the read position to an absolute offset in the file. The position
+  // is clamped to the file.
+  void Seek(int64_t position);
+
+  int64_t position() const { return position_; }
+  int64_t length() const { return length_; }
+
+ private:
+  // Refills the buffer starting at the current position.
+  // @return false at the end of the file or on a read error
+  bool Fill();
+
+  // Reads up to length bytes at the given file offset, retrying on short
+  // reads and EINTR.
+  // @return the number of bytes read
+  int64_t ReadAt(int64_t offset, uint8_t* b, int64_t length);
+
+  int fd_;
+  int64_t position_;
+  int64_t length_;
+  int64_t mark_;
+  std::vector<uint8_t> buffer_;
+  int64_t buffer_start_;  // file offset of buffer_[0]
+  int64_t buffer_end_;    // file offset one past the last buffered byte
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_RANDOM_ACCESS_FILE_INPUT_STREAM_H_
@@ -39,18 +39,15 @@
 // obj.Release();  // ref count = 0, object destroyed
 
 // Notes on usage:
-// 1. Virtual inherit from RefCount interface in base class if smart pointers
-//    are going to be defined.
+// 1. Inherit from RefCount in the base class of a hierarchy if smart pointers
+//    are going to be defined, and from RefCounted<> in standalone classes.
+//    Either way every object has exactly one RefCount subobject.
 // 2. All RefCounted objects must be instantiated on the heap.  Allocating the
 //    object on stack will cause crash.
-// 3. Be careful when you have complex inheritance.  For example,
-//    class A : public RefCounted<A>;
-//    class B : public A, public RefCounted<B>;
-//    In this case the smart pointer is pretty dumb and don't count on it to
-//    nicely destroy your objects as designed. Try refactor your code like
-//    class I;  // the common interface and implementations
-//    class A : public I, public RefCounted<A>;  // A specific implementation
-//    class B : public I, public RefCounted<B>;  // B specific implementation
+// 3. Do not name RefCounted<> again in a class derived from a ref counted one:
+//    class I : public RefCount;  // the common interface and implementations
+//    class A : public I;  // A specific implementation
+//    class B : public I;  // B specific implementation
 // 4. Smart pointers here are very bad candidates for function parameters.  Use
 //    dumb pointers in function parameter list.
 // 5. When down_cast is performed on a dangling pointer due to bugs in code,
@@ -62,6 +59,8 @@
 //    FooPtr end_scope_pointer;
 //    end_scope_pointer.Attach(passThrough);
 //    If you are not passing that object back, you are the end of scope.
+// 7. Ptr<> is movable. std::move a Ptr into a container or another Ptr to
+//    hand its reference over without an AddRef/Release pair.
 
 #ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_REFCOUNT_H_
 #define SFNTLY_CPP_SRC_SFNTLY_PORT_REFCOUNT_H_
@@ -86,93 +85,140 @@
 #if defined (REF_COUNT_DEBUGGING)
   #define DEBUG_OUTPUT(a) \
       fprintf(stderr, "%s%s:oc=%d,oid=%d,rc=%d\n", a, \
-              typeid(this).name(), object_counter_, object_id_, ref_count_)
+              typeid(this).name(), *ObjectCounter(), object_id_, ref_count_)
 #else
   #define DEBUG_OUTPUT(a)
 #endif
 
-#if defined (_MSC_VER)
-  // VC 2008/2010 incorrectly gives this warning for pure virtual functions
-  // in virtual inheritance.  The only way to get around it is to disable it.
-  #pragma warning(disable:4250)
-#endif
-
-bool TestSmartPointer();
-
 namespace sfntly {
 
 template <typename T>
 class Ptr;
 
-class RefCount {
- public:
-  // Make gcc -Wnon-virtual-dtor happy.
-  virtual ~RefCount() {}
+// How an object maintains its reference count. The policy is picked when the
+// object is constructed, from the one in effect on the constructing thread.
+struct RefCountPolicy {
+  enum Type {
+    // Atomic increments and decrements; references may be taken and dropped
+    // on any thread. This is the default.
+    kAtomic,
+    // Plain increments and decrements. Every reference to the object must be
+    // taken and dropped on one thread, e.g. for objects that never leave a
+    // single subset job.
+    kThreadConfined
+  };
+
+  // @return the policy given to objects constructed on the calling thread
+  static Type Current() { return *ThreadPolicy(); }
 
  private:
-  template <typename T>
-  friend class Ptr;
+  friend class RefCountPolicyScope;
 
-  virtual size_t AddRef() const = 0;
-  virtual size_t Release() const = 0;
+  static Type* ThreadPolicy() {
+    static thread_local Type policy = kAtomic;
+    return &policy;
+  }
 };
 
-template <typename TDerived>
-class RefCounted : virtual public RefCount {
+// Sets the policy for objects constructed on the calling thread while the
+// RefCountPolicyScope is in scope. Scopes nest.
+class RefCountPolicyScope {
+ public:
+  explicit RefCountPolicyScope(RefCountPolicy::Type policy)
+      : previous_(*RefCountPolicy::ThreadPolicy()) {
+    *RefCountPolicy::ThreadPolicy() = policy;
+  }
+  ~RefCountPolicyScope() {
+    *RefCountPolicy::ThreadPolicy() = previous_;
+  }
+
+ private:
+  RefCountPolicy::Type previous_;
+  NO_COPY_AND_ASSIGN(RefCountPolicyScope);
+};
+
+// The root of every ref counted class. It is an ordinary (non-virtual) base
+// holding the count itself, so AddRef and Release are inline and never go
+// through the vtable; only the final delete uses the virtual destructor.
+class RefCount {
  public:
-  RefCounted() : ref_count_(0) {
+  virtual ~RefCount() {
+#if defined (ENABLE_OBJECT_COUNTER)
+    AtomicDecrement(ObjectCounter());
+    DEBUG_OUTPUT("D ");
+#endif
+  }
+
+ protected:
+  RefCount()
+      : ref_count_(0),
+        thread_confined_(RefCountPolicy::Current() ==
+                         RefCountPolicy::kThreadConfined) {
 #if defined (ENABLE_OBJECT_COUNTER)
-    object_id_ = AtomicIncrement(&next_id_);
-    AtomicIncrement(&object_counter_);
+    object_id_ = AtomicIncrement(NextId());
+    AtomicIncrement(ObjectCounter());
     DEBUG_OUTPUT("C ");
 #endif
   }
-  RefCounted(const RefCounted<TDerived>&) : ref_count_(0) {}
-  virtual ~RefCounted() {
+  RefCount(const RefCount&)
+      : ref_count_(0),
+        thread_confined_(RefCountPolicy::Current() ==
+                         RefCountPolicy::kThreadConfined) {
 #if defined (ENABLE_OBJECT_COUNTER)
-    AtomicDecrement(&object_counter_);
-    DEBUG_OUTPUT("D ");
+    object_id_ = AtomicIncrement(NextId());
+    AtomicIncrement(ObjectCounter());
 #endif
   }
 
-  RefCounted<TDerived>& operator=(const RefCounted<TDerived>&) {
+  RefCount& operator=(const RefCount&) {
     // Each object maintains own ref count, don't propagate.
     return *this;
   }
 
  private:
-  virtual size_t AddRef() const {
-    size_t new_count = AtomicIncrement(&ref_count_);
+  template <typename T>
+  friend class Ptr;
+
+  size_t AddRef() const {
+    size_t new_count = thread_confined_ ? ++ref_count_ :
+                                          AtomicIncrement(&ref_count_);
     DEBUG_OUTPUT("A ");
     return new_count;
   }
 
-  virtual size_t Release() const {
-    size_t new_ref_count = AtomicDecrement(&ref_count_);
+  size_t Release() const {
+    size_t new_ref_count = thread_confined_ ? --ref_count_ :
+                                              AtomicDecrement(&ref_count_);
     DEBUG_OUTPUT("R ");
     if (new_ref_count == 0) {
-      // A C-style is used to cast away const-ness and to derived.
-      // lint does not like this but this is how it works.
-      delete (TDerived*)(this);
+      delete const_cast<RefCount*>(this);
     }
     return new_ref_count;
   }
 
   mutable size_t ref_count_;  // reference count of current object
-  friend bool ::TestSmartPointer();
+  const bool thread_confined_;
 #if defined (ENABLE_OBJECT_COUNTER)
-  static size_t object_counter_;
-  static size_t next_id_;
-  mutable size_t object_id_;
+  static size_t* ObjectCounter() {
+    static size_t object_counter = 0;
+    return &object_counter;
+  }
+  static size_t* NextId() {
+    static size_t next_id = 0;
+    return &next_id;
+  }
+  size_t object_id_;
 #endif
 };
 
-#if defined (ENABLE_OBJECT_COUNTER)
-template <typename TDerived> size_t RefCounted<TDerived>::object_counter_ = 0;
-template <typename TDerived> size_t RefCounted<TDerived>::next_id_ = 0;
-#endif
+// Convenience base for ref counted classes outside of any of the class
+// hierarchies rooted at RefCount. A class must reach RefCount exactly once:
+// classes derived from e.g. FontData or FontDataTable are already ref counted
+// and do not name RefCounted<> again.
+template <typename TDerived>
+class RefCounted : public RefCount {
+};
 
-// semi-smart pointer for RefCount derived objects, similar to CComPtr
 template <typename T>
 class Ptr {
  public:
@@ -189,6 +235,11 @@ class Ptr {
     *this = p;
   }
 
+  // Takes over the reference held by p without touching the ref count.
+  Ptr(Ptr<T>&& p) noexcept : p_(p.p_) {
+    p.p_ = NULL;
+  }
+
   ~Ptr() {
     Release();
   }
@@ -216,6 +267,15 @@ class Ptr {
     return operator=(p.p_);
   }
 
+  T* operator=(Ptr<T>&& p) noexcept {
+    if (this != &p) {
+      Release();
+      p_ = p.p_;
+      p.p_ = NULL;
+    }
+    return p_;
+  }
+
   operator T*&() {
     return p_;
   }
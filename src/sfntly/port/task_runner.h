@@ -0,0 +1,43 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SFNTLY_CPP_SRC_SFNTLY_PORT_TASK_RUNNER_H_
+#define SFNTLY_CPP_SRC_SFNTLY_PORT_TASK_RUNNER_H_
+
+#include <functional>
+
+namespace sfntly {
+
+// Threads supplied by the application that sfntly may hand spare work to,
+// such as copying the tables of a font being serialized. sfntly starts no
+// threads of its own.
+//
+// Work is only ever offered: the caller keeps doing the work itself and
+// never waits for a posted task to start, so a runner whose threads are all
+// busy (even with the caller's own job) costs nothing but the post.
+class TaskRunner {
+ public:
+  typedef std::function<void()> Task;
+
+  virtual ~TaskRunner() {}
+
+  // Queues the task for another thread if that can be done without waiting.
+  // Tasks must not touch objects with thread-confined reference counts.
+  // @return false if the task was not queued
+  virtual bool TryPostTask(const Task& task) = 0;
+};
+
+}  // namespace sfntly
+
+#endif  // SFNTLY_CPP_SRC_SFNTLY_PORT_TASK_RUNNER_H_
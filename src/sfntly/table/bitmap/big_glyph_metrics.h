@@ -21,8 +21,7 @@
 
 namespace sfntly {
 
-class BigGlyphMetrics : public GlyphMetrics,
-                        public RefCounted<BigGlyphMetrics> {
+class BigGlyphMetrics : public GlyphMetrics {
  public:
   struct Offset {
     enum {
@@ -39,8 +38,7 @@ class BigGlyphMetrics : public GlyphMetrics,
     };
   };
 
-  class Builder : public GlyphMetrics::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public GlyphMetrics::Builder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
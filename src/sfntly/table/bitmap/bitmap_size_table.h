@@ -28,11 +28,9 @@ namespace sfntly {
 //       code.
 #define SFNTLY_BITMAPSIZE_USE_BINARY_SEARCH 0
 
-class BitmapSizeTable : public SubTable,
-                        public RefCounted<BitmapSizeTable> {
+class BitmapSizeTable : public SubTable {
  public:
-  class Builder : public SubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public SubTable::Builder {
    public:
     class BitmapGlyphInfoIterator :
         public RefIterator<BitmapGlyphInfo, Builder> {
@@ -21,8 +21,7 @@
 
 namespace sfntly {
 
-class CompositeBitmapGlyph : public BitmapGlyph,
-                             public RefCounted<CompositeBitmapGlyph> {
+class CompositeBitmapGlyph : public BitmapGlyph {
  public:
   class Component {
    public:
@@ -47,8 +46,7 @@ class CompositeBitmapGlyph : public BitmapGlyph,
     friend class CompositeBitmapGlyph;
   };
 
-  class Builder : public BitmapGlyph::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public BitmapGlyph::Builder {
    public:
     Builder(WritableFontData* data, int32_t format);
     Builder(ReadableFontData* data, int32_t format);
@@ -23,8 +23,7 @@
 
 namespace sfntly {
 
-class EbdtTable : public SubTableContainerTable,
-                  public RefCounted<EbdtTable> {
+class EbdtTable : public SubTableContainerTable {
  public:
   struct Offset {
     enum {
@@ -33,8 +32,7 @@ class EbdtTable : public SubTableContainerTable,
     };
   };
 
-  class Builder : public SubTableContainerTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public SubTableContainerTable::Builder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
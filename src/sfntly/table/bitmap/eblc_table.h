@@ -25,8 +25,7 @@
 
 namespace sfntly {
 
-class EblcTable : public SubTableContainerTable,
-                  public RefCounted<EblcTable> {
+class EblcTable : public SubTableContainerTable {
  public:
   struct Offset {
     enum {
@@ -124,8 +123,7 @@ class EblcTable : public SubTableContainerTable,
     };
   };
 
-  class Builder : public SubTableContainerTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public SubTableContainerTable::Builder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
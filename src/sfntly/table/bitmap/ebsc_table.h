@@ -21,8 +21,7 @@
 
 namespace sfntly {
 
-class EbscTable : public Table,
-                  public RefCounted<EbscTable> {
+class EbscTable : public Table {
  public:
   struct Offset {
     enum {
@@ -47,8 +46,7 @@ class EbscTable : public Table,
     };
   };
 
-  class BitmapScaleTable : public SubTable,
-                           public RefCounted<BitmapScaleTable> {
+  class BitmapScaleTable : public SubTable {
    public:
     virtual ~BitmapScaleTable();
     int32_t PpemX();
@@ -63,8 +61,7 @@ class EbscTable : public Table,
 
   // TODO(stuartg): currently the builder just builds from initial data
   // - need to make fully working but few if any examples to test with
-  class Builder : public Table::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public Table::Builder {
    public:
     virtual ~Builder();
 
@@ -22,11 +22,9 @@
 
 namespace sfntly {
 // Format 1 Index Subtable Entry.
-class IndexSubTableFormat1 : public IndexSubTable,
-                             public RefCounted<IndexSubTableFormat1> {
+class IndexSubTableFormat1 : public IndexSubTable {
  public:
-  class Builder : public IndexSubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public IndexSubTable::Builder {
    public:
     class BitmapGlyphInfoIterator
         : public RefIterator<BitmapGlyphInfo, Builder, IndexSubTable::Builder> {
@@ -22,11 +22,9 @@
 
 namespace sfntly {
 // Format 2 Index Subtable Entry.
-class IndexSubTableFormat2 : public IndexSubTable,
-                             public RefCounted<IndexSubTableFormat2> {
+class IndexSubTableFormat2 : public IndexSubTable {
  public:
-  class Builder : public IndexSubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public IndexSubTable::Builder {
    public:
     class BitmapGlyphInfoIterator
         : public RefIterator<BitmapGlyphInfo, Builder, IndexSubTable::Builder> {
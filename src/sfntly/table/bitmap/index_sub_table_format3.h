@@ -21,11 +21,9 @@
 
 namespace sfntly {
 // Format 3 Index Subtable Entry.
-class IndexSubTableFormat3 : public IndexSubTable,
-                             public RefCounted<IndexSubTableFormat3> {
+class IndexSubTableFormat3 : public IndexSubTable {
  public:
-  class Builder : public IndexSubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public IndexSubTable::Builder {
    public:
     class BitmapGlyphInfoIterator
         : public RefIterator<BitmapGlyphInfo, Builder, IndexSubTable::Builder> {
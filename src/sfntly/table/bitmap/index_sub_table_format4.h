@@ -21,8 +21,7 @@
 
 namespace sfntly {
 
-class IndexSubTableFormat4 : public IndexSubTable,
-                             public RefCounted<IndexSubTableFormat4> {
+class IndexSubTableFormat4 : public IndexSubTable {
  public:
   class CodeOffsetPair {
    public:
@@ -50,8 +49,7 @@ class IndexSubTableFormat4 : public IndexSubTable,
     bool operator()(const CodeOffsetPair& lhs, const CodeOffsetPair& rhs);
   };
 
-  class Builder : public IndexSubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public IndexSubTable::Builder {
    public:
     class BitmapGlyphInfoIterator
         : public RefIterator<BitmapGlyphInfo, Builder, IndexSubTable::Builder> {
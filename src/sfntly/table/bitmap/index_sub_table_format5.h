@@ -22,11 +22,9 @@
 
 namespace sfntly {
 
-class IndexSubTableFormat5 : public IndexSubTable,
-                             public RefCounted<IndexSubTableFormat5> {
+class IndexSubTableFormat5 : public IndexSubTable {
  public:
-  class Builder : public IndexSubTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public IndexSubTable::Builder {
    public:
     class BitmapGlyphInfoIterator
         : public RefIterator<BitmapGlyphInfo, Builder, IndexSubTable::Builder> {
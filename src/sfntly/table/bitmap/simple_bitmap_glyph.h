@@ -21,11 +21,9 @@
 
 namespace sfntly {
 
-class SimpleBitmapGlyph : public BitmapGlyph,
-                          public RefCounted<SimpleBitmapGlyph> {
+class SimpleBitmapGlyph : public BitmapGlyph {
  public:
-  class Builder : public BitmapGlyph::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public BitmapGlyph::Builder {
    public:
     Builder(WritableFontData* data, int32_t format);
     Builder(ReadableFontData* data, int32_t format);
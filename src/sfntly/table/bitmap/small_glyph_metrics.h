@@ -22,8 +22,7 @@
 
 namespace sfntly {
 
-class SmallGlyphMetrics : public GlyphMetrics,
-                          public RefCounted<SmallGlyphMetrics> {
+class SmallGlyphMetrics : public GlyphMetrics {
  public:
   struct Offset {
     enum {
@@ -36,8 +35,7 @@ class SmallGlyphMetrics : public GlyphMetrics,
     };
   };
 
-  class Builder : public GlyphMetrics::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public GlyphMetrics::Builder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
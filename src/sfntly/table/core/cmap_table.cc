@@ -238,6 +238,18 @@ CMapTable::CMap::CMap(ReadableFontData* data, int32_t format,
 CMapTable::CMap::~CMap() {
 }
 
+bool CMapTable::CMap::Contains(int32_t character) {
+  CMap::CharacterIterator* character_iterator = Iterator();
+  if (!character_iterator)
+    return false;
+  bool found = false;
+  while (!found && character_iterator->HasNext()) {
+    found = character_iterator->Next() == character;
+  }
+  delete character_iterator;
+  return found;
+}
+
 /******************************************************************************
  * CMapTable::CMap::Builder class
  ******************************************************************************/
@@ -351,6 +363,11 @@ int32_t CMapTable::CMapFormat0::GlyphId(int32_t character) {
   return data_->ReadUByte(character + Offset::kFormat0GlyphIdArray);
 }
 
+bool CMapTable::CMapFormat0::Contains(int32_t character) {
+  // The iterator stops before the last character code.
+  return character >= 0 && character < 0xff;
+}
+
 CMapTable::CMapFormat0::CMapFormat0(ReadableFontData* data,
                                     const CMapId& cmap_id)
     : CMap(data, CMapFormat::kFormat0, cmap_id) {
@@ -617,6 +634,16 @@ int32_t CMapTable::CMapFormat4::GlyphId(int32_t character) {
   return RetrieveGlyphId(segment, start_code, character);
 }
 
+bool CMapTable::CMapFormat4::Contains(int32_t character) {
+  // The iterator returns every character of every segment.
+  return data_->SearchUShort(StartCodeOffset(seg_count_),
+                             DataSize::kUSHORT,
+                             Offset::kFormat4EndCount,
+                             DataSize::kUSHORT,
+                             seg_count_,
+                             character) != -1;
+}
+
 int32_t CMapTable::CMapFormat4::RetrieveGlyphId(int32_t segment,
                                                 int32_t start_code,
                                                 int32_t character) {
@@ -977,19 +1004,35 @@ void CMapTable::CMapFormat4::Builder::Initialize(ReadableFontData* data) {
     return;
 
   // build segments
+  // The four segment arrays are each read with a single bulk read rather
+  // than one ReadUShort() per field per segment.
   int32_t seg_count = CMapFormat4::SegCount(data);
-  for (int32_t index = 0; index < seg_count; ++index) {
-    Ptr<Segment> segment = new Segment;
-    segment->set_start_count(CMapFormat4::StartCode(data, seg_count, index));
+  if (seg_count > 0) {
+    std::vector<uint16_t> end_codes(seg_count);
+    std::vector<uint16_t> start_codes(seg_count);
+    std::vector<uint16_t> id_deltas(seg_count);
+    std::vector<uint16_t> id_range_offsets(seg_count);
+    if (data->ReadUShortArray(Offset::kFormat4EndCount, seg_count,
+                              &(end_codes[0])) != seg_count ||
+        data->ReadUShortArray(CMapFormat4::StartCodeOffset(seg_count),
+                              seg_count, &(start_codes[0])) != seg_count ||
+        data->ReadUShortArray(CMapFormat4::IdDeltaOffset(seg_count),
+                              seg_count, &(id_deltas[0])) != seg_count ||
+        data->ReadUShortArray(CMapFormat4::IdRangeOffsetOffset(seg_count),
+                              seg_count, &(id_range_offsets[0])) != seg_count) {
+      return;
+    }
+    for (int32_t index = 0; index < seg_count; ++index) {
+      Ptr<Segment> segment = new Segment;
+      segment->set_start_count(start_codes[index]);
 #if defined SFNTLY_DEBUG_CMAP
-    fprintf(stderr, "Segment %d; start %d\n", index, segment->start_count());
+      fprintf(stderr, "Segment %d; start %d\n", index, segment->start_count());
 #endif
-    segment->set_end_count(CMapFormat4::EndCode(data, seg_count, index));
-    segment->set_id_delta(CMapFormat4::IdDelta(data, seg_count, index));
-    segment->set_id_range_offset(CMapFormat4::IdRangeOffset(data,
-                                                           seg_count,
-                                                           index));
-    segments_.push_back(segment);
+      segment->set_end_count(end_codes[index]);
+      segment->set_id_delta(id_deltas[index]);
+      segment->set_id_range_offset(id_range_offsets[index]);
+      segments_.push_back(std::move(segment));
+    }
   }
 
   // build glyph id array
@@ -997,9 +1040,15 @@ void CMapTable::CMapFormat4::Builder::Initialize(ReadableFontData* data) {
   int32_t glyph_id_array_length =
       (CMapFormat4::Length(data) - glyph_id_array_offset)
       / DataSize::kUSHORT;
+#if defined SFNTLY_DEBUG_CMAP
   fprintf(stderr, "id array size %d\n", glyph_id_array_length);
-  for (int32_t i = 0; i < glyph_id_array_length; i += DataSize::kUSHORT) {
-    glyph_id_array_.push_back(data->ReadUShort(glyph_id_array_offset + i));
+#endif
+  if (glyph_id_array_length > 0) {
+    std::vector<uint16_t> glyph_ids(glyph_id_array_length);
+    int32_t read = data->ReadUShortArray(glyph_id_array_offset,
+                                         glyph_id_array_length,
+                                         &(glyph_ids[0]));
+    glyph_id_array_.assign(glyph_ids.begin(), glyph_ids.begin() + read);
   }
 }
 
@@ -1016,6 +1065,11 @@ void CMapTable::CMapFormat4::Builder::set_segments(SegmentList* segments) {
   set_model_changed();
 }
 
+void CMapTable::CMapFormat4::Builder::set_segments(SegmentList&& segments) {
+  segments_ = std::move(segments);
+  set_model_changed();
+}
+
 std::vector<int32_t>* CMapTable::CMapFormat4::Builder::glyph_id_array() {
   if (glyph_id_array_.empty()) {
     Initialize(InternalReadData());
@@ -1030,6 +1084,12 @@ set_glyph_id_array(std::vector<int32_t>* glyph_id_array) {
   set_model_changed();
 }
 
+void CMapTable::CMapFormat4::Builder::
+set_glyph_id_array(std::vector<int32_t>&& glyph_id_array) {
+  glyph_id_array_ = std::move(glyph_id_array);
+  set_model_changed();
+}
+
 CALLER_ATTACH FontDataTable*
 CMapTable::CMapFormat4::Builder::SubBuildTable(ReadableFontData* data) {
   FontDataTablePtr table = new CMapFormat4(data, cmap_id());
@@ -24,6 +24,7 @@
 #include <vector>
 #include <map>
 
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/table/subtable.h"
 #include "sfntly/table/subtable_container_table.h"
@@ -46,7 +47,7 @@ struct CMapFormat {
 };
 
 // A CMap table
-class CMapTable : public SubTableContainerTable, public RefCounted<CMapTable> {
+class CMapTable : public SubTableContainerTable {
 public:
   // CMapTable::CMapId
   struct CMapId {
@@ -204,6 +205,12 @@ public:
     // table.
     virtual int32_t GlyphId(int32_t character) = 0;
 
+    // Checks whether the character is one of those Iterator() returns, so
+    // that a known set of characters can be looked up without walking the
+    // whole cmap. This implementation walks the iterator; formats that can
+    // answer with a lookup override it.
+    virtual bool Contains(int32_t character);
+
    private:
     int32_t format_;
     CMapId cmap_id_;
@@ -213,11 +220,10 @@ public:
   typedef std::map<CMapId, CMapBuilderPtr, CMapIdComparator> CMapBuilderMap;
 
   // A cmap format 0 sub table
-  class CMapFormat0 : public CMap, public RefCounted<CMapFormat0> {
+  class CMapFormat0 : public CMap {
    public:
     // The fully qualified name is CMapTable::CMapFormat0::Builder
-    class Builder : public CMap::Builder,
-                    public RefCounted<Builder> {
+    class Builder : public CMap::Builder {
      public:
       CALLER_ATTACH static Builder* NewInstance(ReadableFontData* data,
                                                 int32_t offset,
@@ -256,6 +262,7 @@ public:
     virtual ~CMapFormat0();
     virtual int32_t Language();
     virtual int32_t GlyphId(int32_t character);
+    virtual bool Contains(int32_t character);
     CMap::CharacterIterator* Iterator();
 
    private:
@@ -265,11 +272,10 @@ public:
   // A cmap format 2 sub table
   // The format 2 cmap is used for multi-byte encodings such as SJIS,
   // EUC-JP/KR/CN, Big5, etc.
-  class CMapFormat2 : public CMap, public RefCounted<CMapFormat2> {
+  class CMapFormat2 : public CMap {
    public:
     // CMapTable::CMapFormat2::Builder
-    class Builder : public CMap::Builder,
-                    public RefCounted<Builder> {
+    class Builder : public CMap::Builder {
      public:
       Builder(ReadableFontData* data,
               int32_t offset,
@@ -317,15 +323,13 @@ public:
   };
 
     // CMapTable::CMapFormat4
-  class CMapFormat4 : public CMap,
-                      public RefCounted<CMapFormat4> {
+  class CMapFormat4 : public CMap {
    public:
     // CMapTable::CMapFormat4::Builder
-    class Builder : public CMap::Builder,
-                    public RefCounted<Builder> {
+    class Builder : public CMap::Builder {
      public:
         // CMapTable::CMapFormat4::Builder::Segment
-      class Segment : public RefCounted<Segment> {
+      class Segment : public RefCounted<Segment>, public ArenaAllocated {
        public:
         Segment();
         explicit Segment(Segment* other);
@@ -374,8 +378,12 @@ public:
       virtual ~Builder();
       SegmentList* segments();
       void set_segments(SegmentList* segments);
+      // Takes over the segments instead of copying them.
+      void set_segments(SegmentList&& segments);
       std::vector<int32_t>* glyph_id_array();
       void set_glyph_id_array(std::vector<int32_t>* glyph_id_array);
+      // Takes over the glyph id array instead of copying it.
+      void set_glyph_id_array(std::vector<int32_t>&& glyph_id_array);
 
      protected:
       Builder(WritableFontData* data, int32_t offset, const CMapId& cmap_id);
@@ -419,6 +427,7 @@ public:
     };
 
     virtual int32_t GlyphId(int32_t character);
+    virtual bool Contains(int32_t character);
 
     // Lower level glyph code retrieval that requires processing the Format 4
     // segments to use.
@@ -493,8 +502,7 @@ public:
   };
 
   // CMapTable::Builder
-  class Builder : public SubTableContainerTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public SubTableContainerTable::Builder {
    public:
     // Constructor scope is public because C++ does not allow base class to
     // instantiate derived class with protected constructors.
@@ -40,9 +40,9 @@ struct FontDirectionHint {
   };
 };
 
-class FontHeaderTable : public Table, public RefCounted<FontHeaderTable> {
+class FontHeaderTable : public Table {
  public:
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
@@ -23,11 +23,9 @@
 namespace sfntly {
 
 // A Horizontal Device Metrics table - 'hdmx'
-class HorizontalDeviceMetricsTable
-    : public Table,
-      public RefCounted<HorizontalDeviceMetricsTable> {
+class HorizontalDeviceMetricsTable : public Table {
  public:
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
@@ -57,14 +55,14 @@ class HorizontalDeviceMetricsTable
  private:
   struct Offset {
     enum {
-      kVersion = 0,
-      kNumRecords = 2,
-      kSizeDeviceRecord = 4,
-      kRecords = 8,
-
-      // Offsets within a device record
-      kDeviceRecordPixelSize = 0,
-      kDeviceRecordMaxWidth = 1,
+      kVersion = 0,
+      kNumRecords = 2,
+      kSizeDeviceRecord = 4,
+      kRecords = 8,
+
+      // Offsets within a device record
+      kDeviceRecordPixelSize = 0,
+      kDeviceRecordMaxWidth = 1,
       kDeviceRecordWidths = 2,
     };
   };
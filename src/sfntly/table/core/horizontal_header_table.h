@@ -23,11 +23,10 @@
 namespace sfntly {
 
 // A Horizontal Header table - 'hhea'.
-class HorizontalHeaderTable : public Table,
-                              public RefCounted<HorizontalHeaderTable> {
+class HorizontalHeaderTable : public Table {
  public:
   // Builder for a Horizontal Header table - 'hhea'.
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
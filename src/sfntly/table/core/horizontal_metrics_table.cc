@@ -90,6 +90,43 @@ HorizontalMetricsTable::HorizontalMetricsTable(Header* header,
       num_glyphs_(num_glyphs) {
 }
 
+bool HorizontalMetricsTable::Metrics(std::vector<int32_t>* advance_widths,
+                                     std::vector<int32_t>* lsbs) {
+  assert(advance_widths);
+  assert(lsbs);
+  if (num_hmetrics_ <= 0 || num_glyphs_ < num_hmetrics_)
+    return false;
+  // The hMetrics array is (advanceWidth, lsb) pairs; read it as one run of
+  // USHORTs and reinterpret the odd entries as signed.
+  std::vector<uint16_t> hmetrics(2 * num_hmetrics_);
+  if (data_->ReadUShortArray(Offset::kHMetricsStart, hmetrics.size(),
+                             &(hmetrics[0])) != (int32_t)hmetrics.size()) {
+    return false;
+  }
+  int32_t num_lsbs = NumberOfLSBs();
+  std::vector<int16_t> lsb_table(num_lsbs);
+  if (num_lsbs > 0 &&
+      data_->ReadShortArray(Offset::kHMetricsStart +
+                            num_hmetrics_ * Offset::kHMetricsSize,
+                            num_lsbs,
+                            &(lsb_table[0])) != num_lsbs) {
+    return false;
+  }
+
+  advance_widths->resize(num_glyphs_);
+  lsbs->resize(num_glyphs_);
+  for (int32_t i = 0; i < num_hmetrics_; ++i) {
+    (*advance_widths)[i] = hmetrics[2 * i];
+    (*lsbs)[i] = static_cast<int16_t>(hmetrics[2 * i + 1]);
+  }
+  int32_t last_advance_width = hmetrics[2 * (num_hmetrics_ - 1)];
+  for (int32_t i = 0; i < num_lsbs; ++i) {
+    (*advance_widths)[num_hmetrics_ + i] = last_advance_width;
+    (*lsbs)[num_hmetrics_ + i] = lsb_table[i];
+  }
+  return true;
+}
+
 /******************************************************************************
  * HorizontalMetricsTable::Builder class
  ******************************************************************************/
@@ -23,11 +23,10 @@
 namespace sfntly {
 
 // A Horizontal Metrics table - 'hmtx'.
-class HorizontalMetricsTable : public Table,
-                               public RefCounted<HorizontalMetricsTable> {
+class HorizontalMetricsTable : public Table {
  public:
   // Builder for a Horizontal Metrics Table - 'hmtx'.
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
@@ -56,6 +55,15 @@ class HorizontalMetricsTable : public Table,
   int32_t AdvanceWidth(int32_t glyph_id);
   int32_t LeftSideBearing(int32_t glyph_id);
 
+  // Decode the advance width and left side bearing of every glyph using bulk
+  // reads of the hMetrics and leftSideBearing arrays. Glyphs past the last
+  // hMetric share its advance width.
+  // @param advance_widths receives num_glyphs advance widths
+  // @param lsbs receives num_glyphs left side bearings
+  // @return true if the table data could be read
+  bool Metrics(std::vector<int32_t>* advance_widths,
+               std::vector<int32_t>* lsbs);
+
  private:
   struct Offset {
     enum {
@@ -24,11 +24,10 @@
 namespace sfntly {
 
 // A Maximum Profile table - 'maxp'.
-class MaximumProfileTable : public Table,
-                            public RefCounted<MaximumProfileTable> {
+class MaximumProfileTable : public Table {
  public:
   // Builder for a Maximum Profile table - 'maxp'.
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
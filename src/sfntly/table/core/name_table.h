@@ -409,7 +409,7 @@ struct WindowsLanguageId {
   };
 };
 
-class NameTable : public SubTableContainerTable, public RefCounted<NameTable> {
+class NameTable : public SubTableContainerTable {
  public:
   // Unique identifier for a given name record.
   class NameEntryId {
@@ -567,8 +567,7 @@ class NameTable : public SubTableContainerTable, public RefCounted<NameTable> {
   };
 
   // The builder to construct name table for outputting.
-  class Builder : public SubTableContainerTable::Builder,
-                  public RefCounted<Builder> {
+  class Builder : public SubTableContainerTable::Builder {
    public:
     // Constructor scope altered to public because C++ does not allow base
     // class to instantiate derived class with protected constructors.
@@ -310,10 +310,10 @@ struct CodePageRange {
 };
 
 // An OS/2 table - 'OS/2'.
-class OS2Table : public Table, public RefCounted<OS2Table> {
+class OS2Table : public Table {
  public:
   // A builder for the OS/2 table = 'OS/2'.
-  class Builder : public TableBasedTableBuilder, public RefCounted<Builder> {
+  class Builder : public TableBasedTableBuilder {
    public:
     Builder(Header* header, WritableFontData* data);
     Builder(Header* header, ReadableFontData* data);
@@ -314,16 +314,18 @@ std::string PostScriptTable::GlyphName(int32_t glyphNum) {
     if (glyphNameIndex < NUM_STANDARD_NAMES) {
         return STANDARD_NAMES[glyphNameIndex];
     }
-    return getNames()[glyphNameIndex - NUM_STANDARD_NAMES];
+    const std::vector<std::string>& names = getNames();
+    if (glyphNameIndex - NUM_STANDARD_NAMES >= (int32_t)names.size()) {
+        return "";
+    }
+    return names[glyphNameIndex - NUM_STANDARD_NAMES];
 }
 
-std::vector<std::string> PostScriptTable::getNames() {
-    std::vector<std::string> result = names_;
-    if (result.empty() && this->Version() == VERSION_2){
-        result = this->parse();
-        names_ = result;
+const std::vector<std::string>& PostScriptTable::getNames() {
+    if (names_.empty() && this->Version() == VERSION_2){
+        names_ = this->parse();
     }
-    return result;
+    return names_;
 }
 
 std::vector<std::string> PostScriptTable::parse() {
@@ -334,7 +336,7 @@ std::vector<std::string> PostScriptTable::parse() {
             int32_t strlen = this->data_->ReadUByte(index);
             uint8_t* nameBytes = new uint8_t[strlen];
             this->data_->ReadBytes(index + 1, nameBytes, 0, strlen);
-            names.emplace_back((char*)nameBytes);
+            names.emplace_back((char*)nameBytes, strlen);
             index += 1 + strlen;
             delete[] nameBytes;
         }
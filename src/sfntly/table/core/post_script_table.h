@@ -5,13 +5,14 @@
 #ifndef FONT_SUBSETTER_POST_SCRIPT_TABLE_H
 #define FONT_SUBSETTER_POST_SCRIPT_TABLE_H
 
+#include <string>
+
 #include "sfntly/table/table.h"
 #include <sfntly/table/table_based_table_builder.h>
 
 namespace sfntly {
 
-class PostScriptTable : public Table,
-                        public RefCounted<PostScriptTable>{
+class PostScriptTable : public Table {
 public:
     static const int32_t VERSION_1;
     static const int32_t VERSION_2;
@@ -43,14 +44,14 @@ public:
     std::string GlyphName(int32_t glyphNum);
 
 private:
-    std::vector<std::string> getNames();
+    const std::vector<std::string>& getNames();
     std::vector<std::string> parse();
 
 
     std::vector<std::string> names_;
 
 public:
-    class Builder: public TableBasedTableBuilder, public RefCounted<Builder> {
+    class Builder : public TableBasedTableBuilder {
     public:
         Builder(Header* header, WritableFontData* data);
         Builder(Header* header, ReadableFontData* data);
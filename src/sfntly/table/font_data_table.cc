@@ -76,6 +76,10 @@ void FontDataTable::Builder::SetData(ReadableFontData* data) {
   InternalSetData(data, true);
 }
 
+void FontDataTable::Builder::ShareData(ReadableFontData* data) {
+  InternalSetData(data, false);
+}
+
 
 CALLER_ATTACH FontDataTable* FontDataTable::Builder::Build() {
   FontDataTablePtr table;  // NULL default table
@@ -132,6 +136,9 @@ WritableFontData* FontDataTable::Builder::InternalWriteData() {
 #endif
     InternalSetData(new_data, false);
   }
+  // Writes through the returned data bypass the model, so assume they happen;
+  // otherwise a table built from it would keep a stale recorded checksum.
+  data_changed_ = true;
   return w_data_.p_;
 }
 
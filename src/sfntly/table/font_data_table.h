@@ -19,17 +19,18 @@
 
 #include "sfntly/data/readable_font_data.h"
 #include "sfntly/data/writable_font_data.h"
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 
 namespace sfntly {
 
 // An abstract base for any table that contains a FontData. This is the root of
 // the table class hierarchy.
-class FontDataTable : virtual public RefCount {
+class FontDataTable : public RefCount, public ArenaAllocated {
  public:
   // Note: original version is abstract Builder<T extends FontDataTable>
   //       C++ template is not designed that way so plain class is chosen.
-  class Builder : virtual public RefCount {
+  class Builder : public RefCount, public ArenaAllocated {
    public:
     // Get a snapshot copy of the internal data of the builder.
     // This causes any internal data structures to be serialized to a new data
@@ -76,6 +77,11 @@ class FontDataTable : virtual public RefCount {
     Builder(ReadableFontData* data);
     virtual ~Builder();
 
+    // Use the data as the backing store for reads without marking it changed.
+    // The data is shared, not copied; a writable copy is taken only on the
+    // first write through InternalWriteData().
+    void ShareData(ReadableFontData* data);
+
     // subclass API
     virtual void NotifyPostTableBuild(FontDataTable* table);
     virtual int32_t SubSerialize(WritableFontData* new_data) = 0;
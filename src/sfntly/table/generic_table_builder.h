@@ -22,8 +22,7 @@
 namespace sfntly {
 
 // A table builder to do the minimal table building for an unknown table type.
-class GenericTableBuilder : public TableBasedTableBuilder,
-                            public RefCounted<GenericTableBuilder> {
+class GenericTableBuilder : public TableBasedTableBuilder {
  public:
   virtual ~GenericTableBuilder();
 
@@ -17,11 +17,12 @@
 #ifndef SFNTLY_CPP_SRC_SFNTLY_TABLE_HEADER_H_
 #define SFNTLY_CPP_SRC_SFNTLY_TABLE_HEADER_H_
 
+#include "sfntly/port/arena.h"
 #include "sfntly/port/refcount.h"
 
 namespace sfntly {
 
-class Header : public RefCounted<Header> {
+class Header : public RefCounted<Header>, public ArenaAllocated {
  public:
   // Make a partial header with only the basic info for an empty new table.
   explicit Header(int32_t tag);
@@ -146,6 +146,25 @@ Table::Builder* Table::Builder::GetBuilder(Header* header,
   return builder_raw;
 }
 
+CALLER_ATTACH
+Table::Builder* Table::Builder::GetSharedBuilder(Header* header,
+                                                 ReadableFontData* table_data) {
+  // The typed builders do no work at construction, so start with no data and
+  // hand over the shared data without marking it changed. The builder gets
+  // its own wrapper over the shared bytes: tables set state on the data they
+  // are built on, e.g. the head table's checksum ranges, and the source data
+  // may be shared with builders on other threads.
+  TableBuilderPtr builder;
+  builder.Attach(GetBuilder(header, NULL));
+  if (builder != NULL) {
+    ReadableFontDataPtr data;
+    data.Attach(down_cast<ReadableFontData*>(
+        table_data->Slice(0, table_data->Length())));
+    builder->ShareData(data);
+  }
+  return builder.Detach();
+}
+
 Table::Builder::Builder(Header* header, WritableFontData* data)
     : FontDataTable::Builder(data) {
   header_ = header;
@@ -50,6 +50,15 @@ class Table : public FontDataTable {
     static CALLER_ATTACH Builder* GetBuilder(Header* header,
                                              WritableFontData* table_data);
 
+    // Get a builder for the table type specified by the data in the header
+    // that shares the given data instead of taking a writable copy. The data
+    // is only copied if the builder is later written to directly.
+    // @param header the header for the table
+    // @param table_data the data to be used to build the table from
+    // @return builder for the table specified
+    static CALLER_ATTACH Builder* GetSharedBuilder(Header* header,
+                                                   ReadableFontData* table_data);
+
     // UNIMPLEMENTED: toString()
 
    protected:
@@ -97,7 +106,7 @@ class Table : public FontDataTable {
 };
 
 // C++ port only
-class GenericTable : public Table, public RefCounted<GenericTable> {
+class GenericTable : public Table {
  public:
   GenericTable(Header* header, ReadableFontData* data) : Table(header, data) {}
   virtual ~GenericTable() {}
@@ -42,6 +42,8 @@ void TableBasedTableBuilder::SubDataSet() {
 
 CALLER_ATTACH FontDataTable* TableBasedTableBuilder::Build() {
   FontDataTablePtr table = static_cast<FontDataTable*>(GetTable());
+  if (table != NULL)
+    NotifyPostTableBuild(table);
   return table.Detach();
 }
 
@@ -60,8 +62,12 @@ TableBasedTableBuilder::TableBasedTableBuilder(Header* header)
 }
 
 Table* TableBasedTableBuilder::GetTable() {
+  ReadableFontData* data = InternalReadData();
+  // Shared data is replaced by a private copy on the first write, which
+  // leaves a table built over the shared data stale.
+  if (table_ && table_->ReadFontData() != data)
+    table_ = NULL;
   if (!table_) {
-    ReadableFontData* data = InternalReadData();
     if (data)
       table_.Attach(down_cast<Table*>(SubBuildTable(data)));
   }
@@ -18,6 +18,8 @@
 
 #include <stdlib.h>
 
+#include <utility>
+
 #include "sfntly/port/exception_type.h"
 
 namespace sfntly {
@@ -109,6 +111,11 @@ void GlyphTable::Builder::SetGlyphBuilders(GlyphBuilderList* glyph_builders) {
   set_model_changed();
 }
 
+void GlyphTable::Builder::SetGlyphBuilders(GlyphBuilderList&& glyph_builders) {
+  glyph_builders_ = std::move(glyph_builders);
+  set_model_changed();
+}
+
 CALLER_ATTACH GlyphTable::Glyph::Builder*
     GlyphTable::Builder::GlyphBuilder(ReadableFontData* data) {
   return Glyph::Builder::GetBuilder(this, data);
@@ -173,7 +180,7 @@ void GlyphTable::Builder::Initialize(ReadableFontData* data,
                                    data,
                                    last_loca_value /*offset*/,
                                    loca_value - last_loca_value /*length*/));
-      glyph_builders_.push_back(builder);
+      glyph_builders_.push_back(std::move(builder));
       last_loca_value = loca_value;
     }
   }
@@ -537,6 +544,19 @@ int32_t GlyphTable::CompositeGlyph::GlyphIndex(int32_t contour) {
   return data_->ReadUShort(DataSize::kUSHORT + contour_index_[contour]);
 }
 
+// static
+bool GlyphTable::CompositeGlyph::ComponentGlyphIds(
+    FontDataSpan glyph, std::vector<int32_t>* glyph_ids) {
+  assert(glyph_ids);
+  GlyphView view(glyph);
+  if (!view.IsComposite())
+    return false;
+  for (GlyphView::ComponentIterator it = view.Components(); it.HasNext();) {
+    glyph_ids->push_back(it.Next());
+  }
+  return true;
+}
+
 int32_t GlyphTable::CompositeGlyph::InstructionSize() {
   return instruction_size_;
 }
@@ -612,4 +632,47 @@ CALLER_ATTACH FontDataTable*
   return table.Detach();
 }
 
+/******************************************************************************
+ * GlyphTable::GlyphView class
+ ******************************************************************************/
+GlyphTable::GlyphView::ComponentIterator::ComponentIterator(FontDataSpan glyph,
+                                                            bool composite)
+    : glyph_(glyph),
+      index_(5 * DataSize::kUSHORT),
+      flags_(0),
+      more_components_(composite) {
+}
+
+bool GlyphTable::GlyphView::ComponentIterator::HasNext() const {
+  // flags and glyphIndex
+  return more_components_ && glyph_.Contains(index_, 2 * DataSize::kUSHORT);
+}
+
+int32_t GlyphTable::GlyphView::ComponentIterator::Next() {
+  assert(HasNext());
+  flags_ = glyph_.ReadUShort(index_);
+  int32_t glyph_index = glyph_.ReadUShort(index_ + DataSize::kUSHORT);
+
+  index_ += 2 * DataSize::kUSHORT;
+  if ((flags_ & CompositeGlyph::kFLAG_ARG_1_AND_2_ARE_WORDS) ==
+      CompositeGlyph::kFLAG_ARG_1_AND_2_ARE_WORDS) {
+    index_ += 2 * DataSize::kSHORT;
+  } else {
+    index_ += 2 * DataSize::kBYTE;
+  }
+  if ((flags_ & CompositeGlyph::kFLAG_WE_HAVE_A_SCALE) ==
+      CompositeGlyph::kFLAG_WE_HAVE_A_SCALE) {
+    index_ += DataSize::kF2DOT14;
+  } else if ((flags_ & CompositeGlyph::kFLAG_WE_HAVE_AN_X_AND_Y_SCALE) ==
+             CompositeGlyph::kFLAG_WE_HAVE_AN_X_AND_Y_SCALE) {
+    index_ += 2 * DataSize::kF2DOT14;
+  } else if ((flags_ & CompositeGlyph::kFLAG_WE_HAVE_A_TWO_BY_TWO) ==
+             CompositeGlyph::kFLAG_WE_HAVE_A_TWO_BY_TWO) {
+    index_ += 4 * DataSize::kF2DOT14;
+  }
+  more_components_ = (flags_ & CompositeGlyph::kFLAG_MORE_COMPONENTS) ==
+                     CompositeGlyph::kFLAG_MORE_COMPONENTS;
+  return glyph_index;
+}
+
 }  // namespace sfntly
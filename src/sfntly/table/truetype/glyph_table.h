@@ -19,6 +19,7 @@
 
 #include <vector>
 
+#include "sfntly/port/lock.h"
 #include "sfntly/table/table.h"
 #include "sfntly/table/subtable.h"
 #include "sfntly/table/subtable_container_table.h"
@@ -32,8 +33,7 @@ struct GlyphType {
   };
 };
 
-class GlyphTable : public SubTableContainerTable,
-                   public RefCounted<GlyphTable> {
+class GlyphTable : public SubTableContainerTable {
  public:
   class Builder;
   class Glyph : public SubTable {
@@ -108,8 +108,7 @@ class GlyphTable : public SubTableContainerTable,
   typedef Ptr<GlyphTable::Glyph::Builder> GlyphBuilderPtr;
   typedef std::vector<GlyphBuilderPtr> GlyphBuilderList;
 
-  class Builder : public SubTableContainerTable::Builder,
-                  public RefCounted<GlyphTable::Builder> {
+  class Builder : public SubTableContainerTable::Builder {
    public:
     // Note: Constructor scope altered to public for base class to instantiate.
     Builder(Header* header, ReadableFontData* data);
@@ -138,6 +137,8 @@ class GlyphTable : public SubTableContainerTable,
     // the GlyphTable.Builder::GlyphBuilders() is being used and modified
     // then those changes will already be reflected in the glyph table builder.
     void SetGlyphBuilders(GlyphBuilderList* glyph_builders);
+    // Same as above, but takes over the list instead of copying it.
+    void SetGlyphBuilders(GlyphBuilderList&& glyph_builders);
 
     // Glyph builder factories
     CALLER_ATTACH Glyph::Builder* GlyphBuilder(ReadableFontData* data);
@@ -158,7 +159,7 @@ class GlyphTable : public SubTableContainerTable,
     std::vector<int32_t> loca_;
   };
 
-  class SimpleGlyph : public Glyph, public RefCounted<SimpleGlyph> {
+  class SimpleGlyph : public Glyph {
    public:
     static const int32_t kFLAG_ONCURVE;
     static const int32_t kFLAG_XSHORT;
@@ -173,8 +174,7 @@ class GlyphTable : public SubTableContainerTable,
       virtual ~SimpleContour() {}
     };
 
-    class SimpleGlyphBuilder : public Glyph::Builder,
-                               public RefCounted<SimpleGlyphBuilder> {
+    class SimpleGlyphBuilder : public Glyph::Builder {
      public:
       virtual ~SimpleGlyphBuilder();
 
@@ -225,7 +225,7 @@ class GlyphTable : public SubTableContainerTable,
     std::vector<int32_t> contour_index_;
   };
 
-  class CompositeGlyph : public Glyph, public RefCounted<CompositeGlyph> {
+  class CompositeGlyph : public Glyph {
    public:
     static const int32_t kFLAG_ARG_1_AND_2_ARE_WORDS;
     static const int32_t kFLAG_ARGS_ARE_XY_VALUES;
@@ -241,8 +241,7 @@ class GlyphTable : public SubTableContainerTable,
     static const int32_t kFLAG_SCALED_COMPONENT_OFFSET;
     static const int32_t kFLAG_UNSCALED_COMPONENT_OFFSET;
 
-    class CompositeGlyphBuilder : public Glyph::Builder,
-                                  public RefCounted<CompositeGlyphBuilder> {
+    class CompositeGlyphBuilder : public Glyph::Builder {
      public:
       virtual ~CompositeGlyphBuilder();
 
@@ -267,6 +266,14 @@ class GlyphTable : public SubTableContainerTable,
     int32_t Flags(int32_t contour);
     int32_t NumGlyphs();
     int32_t GlyphIndex(int32_t contour);
+
+    // Collects the component glyph ids of a composite glyph from its raw data,
+    // as GlyphView::Components() walks them.
+    // @param glyph the data of a single glyph
+    // @param glyph_ids receives the glyph ids of the components
+    // @return false if the span does not hold a composite glyph
+    static bool ComponentGlyphIds(FontDataSpan glyph,
+                                  std::vector<int32_t>* glyph_ids);
     virtual int32_t InstructionSize();
     virtual CALLER_ATTACH ReadableFontData* Instructions();
 
@@ -281,6 +288,57 @@ class GlyphTable : public SubTableContainerTable,
     Lock initialization_lock_;
   };
 
+  // A view of the raw data of one glyph that answers the questions subsetting
+  // asks: how many contours the glyph has and, for a composite glyph, which
+  // glyphs it references. Everything is read straight from the glyf bytes;
+  // a view holds no state beyond the span and allocates nothing, unlike
+  // GetGlyph(), which slices the data and builds a Glyph to parse lazily.
+  class GlyphView {
+   public:
+    // Walks the component records of a composite glyph. Iteration stops after
+    // the record without kFLAG_MORE_COMPONENTS, or at the first record that
+    // does not fit in the glyph's data.
+    class ComponentIterator {
+     public:
+      bool HasNext() const;
+      // @return the glyph index of the next component
+      int32_t Next();
+      // @return the flags of the component last returned by Next()
+      int32_t flags() const { return flags_; }
+
+     private:
+      friend class GlyphView;
+      ComponentIterator(FontDataSpan glyph, bool composite);
+
+      FontDataSpan glyph_;
+      int32_t index_;
+      int32_t flags_;
+      bool more_components_;
+    };
+
+    explicit GlyphView(FontDataSpan glyph) : glyph_(glyph) {}
+
+    // @return false if the data is too short for a glyph header, as for the
+    //         empty glyphs of blank characters
+    bool HasHeader() const {
+      return glyph_.Contains(Offset::kNumberOfContours, DataSize::kSHORT);
+    }
+    // @return the number of contours; negative for a composite glyph and 0
+    //         for a glyph without a header
+    int32_t NumberOfContours() const {
+      return HasHeader() ? glyph_.ReadShort(Offset::kNumberOfContours) : 0;
+    }
+    bool IsComposite() const { return NumberOfContours() < 0; }
+    // @return an iterator over the components; it has none unless the glyph
+    //         is composite
+    ComponentIterator Components() const {
+      return ComponentIterator(glyph_, IsComposite());
+    }
+
+   private:
+    FontDataSpan glyph_;
+  };
+
   virtual ~GlyphTable();
 
   // C++ port: rename glyph() to GetGlyph().
@@ -189,13 +189,14 @@ bool LocaTable::Builder::SubReadyToSerialize() {
 
 int32_t LocaTable::Builder::SubSerialize(WritableFontData* new_data) {
   int32_t size = 0;
-  for (std::vector<int32_t>::iterator l = loca_.begin(), end = loca_.end();
-                             l != end; ++l) {
-    if (format_version_ == IndexToLocFormat::kLongOffset) {
-      size += new_data->WriteULong(size, *l);
-    } else {
-      size += new_data->WriteUShort(size, *l / 2);
+  if (format_version_ == IndexToLocFormat::kLongOffset) {
+    size = new_data->WriteLongArray(0, &(loca_[0]), loca_.size());
+  } else {
+    std::vector<uint16_t> locas(loca_.size());
+    for (size_t i = 0; i < loca_.size(); ++i) {
+      locas[i] = static_cast<uint16_t>(loca_[i] / 2);
     }
+    size = new_data->WriteUShortArray(0, &(locas[0]), locas.size());
   }
   num_glyphs_ = loca_.size() - 1;
   return size;
@@ -210,12 +211,22 @@ void LocaTable::Builder::Initialize(ReadableFontData* data) {
 #endif
       return;
     }
-    LocaTablePtr table =
-        new LocaTable(header(), data, format_version_, num_glyphs_);
-    Ptr<LocaTable::LocaIterator> loca_iter =
-        new LocaTable::LocaIterator(table);
-    while (loca_iter->HasNext()) {
-      loca_.push_back(loca_iter->Next());
+    // Decode the whole table in one bulk read instead of going through
+    // LocaIterator one entry at a time.
+    int32_t num_locas = num_glyphs_ + 1;
+    if (format_version_ == IndexToLocFormat::kLongOffset) {
+      std::vector<uint32_t> locas(num_locas);
+      if (data->ReadULongArray(0, num_locas, &(locas[0])) != num_locas)
+        return;
+      loca_.assign(locas.begin(), locas.end());
+    } else {
+      std::vector<uint16_t> locas(num_locas);
+      if (data->ReadUShortArray(0, num_locas, &(locas[0])) != num_locas)
+        return;
+      loca_.resize(num_locas);
+      for (int32_t i = 0; i < num_locas; ++i) {
+        loca_[i] = 2 * locas[i];
+      }
     }
   }
 }
@@ -24,7 +24,7 @@
 namespace sfntly {
 
 // A Loca table - 'loca'.
-class LocaTable : public Table, public RefCounted<LocaTable> {
+class LocaTable : public Table {
  public:
   class LocaIterator : public PODIterator<int32_t, LocaTable> {
    public:
@@ -38,7 +38,7 @@ class LocaTable : public Table, public RefCounted<LocaTable> {
     int32_t index_;
   };
 
-  class Builder : public Table::Builder, public RefCounted<Builder> {
+  class Builder : public Table::Builder {
    public:
     // Constructor scope altered to public for base class to instantiate.
     Builder(Header* header, WritableFontData* data);
@@ -14,12 +14,27 @@
  * limitations under the License.
  */
 
+#include <utility>
+
 #include "sfntly/port/refcount.h"
 #include "subtly/character_predicate.h"
 
 namespace subtly {
 using namespace sfntly;
 
+// CharacterPredicate
+int64_t CharacterPredicate::CharacterCount() const {
+  return -1;
+}
+
+void CharacterPredicate::GetCharacters(IntegerList* characters) const {
+  UNREFERENCED_PARAMETER(characters);
+}
+
+const CodepointSet* CharacterPredicate::codepoint_set() const {
+  return NULL;
+}
+
 // AcceptRange predicate
 AcceptRange::AcceptRange(int32_t start, int32_t end)
     : start_(start),
@@ -32,6 +47,19 @@ bool AcceptRange::operator()(int32_t character) const {
   return start_ <= character && character <= end_;
 }
 
+int64_t AcceptRange::CharacterCount() const {
+  return start_ <= end_ ? (int64_t)end_ - start_ + 1 : 0;
+}
+
+void AcceptRange::GetCharacters(IntegerList* characters) const {
+  if (start_ > end_)
+    return;
+  characters->reserve(characters->size() + (size_t)CharacterCount());
+  for (int64_t character = start_; character <= end_; ++character) {
+    characters->push_back((int32_t)character);
+  }
+}
+
 // AcceptSet predicate
 AcceptSet::AcceptSet(IntegerSet* characters)
     : characters_(characters) {
@@ -45,6 +73,44 @@ bool AcceptSet::operator()(int32_t character) const {
   return characters_->find(character) != characters_->end();
 }
 
+int64_t AcceptSet::CharacterCount() const {
+  return (int64_t)characters_->size();
+}
+
+void AcceptSet::GetCharacters(IntegerList* characters) const {
+  characters->insert(characters->end(), characters_->begin(),
+                     characters_->end());
+}
+
+// AcceptCodepoints predicate
+AcceptCodepoints::AcceptCodepoints(const CodepointSet& codepoints)
+    : codepoints_(codepoints),
+      count_(codepoints_.Count()) {
+}
+
+AcceptCodepoints::AcceptCodepoints(CodepointSet&& codepoints)
+    : codepoints_(std::move(codepoints)),
+      count_(codepoints_.Count()) {
+}
+
+AcceptCodepoints::~AcceptCodepoints() {}
+
+bool AcceptCodepoints::operator()(int32_t character) const {
+  return codepoints_.Contains(character);
+}
+
+int64_t AcceptCodepoints::CharacterCount() const {
+  return count_;
+}
+
+void AcceptCodepoints::GetCharacters(IntegerList* characters) const {
+  codepoints_.GetCodepoints(characters);
+}
+
+const CodepointSet* AcceptCodepoints::codepoint_set() const {
+  return &codepoints_;
+}
+
 // AcceptAll predicate
 bool AcceptAll::operator()(int32_t character) const {
   UNREFERENCED_PARAMETER(character);
@@ -19,22 +19,37 @@
 
 #include "sfntly/port/refcount.h"
 #include "sfntly/port/type.h"
+#include "subtly/codepoint_set.h"
 
 namespace subtly {
-class CharacterPredicate : virtual public sfntly::RefCount {
+class CharacterPredicate : public sfntly::RefCount {
  public:
   CharacterPredicate() {}
   virtual ~CharacterPredicate() {}
   virtual bool operator()(int32_t character) const = 0;
+
+  // Predicates accepting a known set of characters can list it, so that a
+  // subset looks up just those characters instead of testing every character
+  // of the cmap.
+  // @return the number of characters accepted; -1 if they cannot be listed
+  virtual int64_t CharacterCount() const;
+  // Appends the accepted characters in increasing order. Appends nothing if
+  // CharacterCount() is -1.
+  virtual void GetCharacters(sfntly::IntegerList* characters) const;
+  // Predicates backed by a CodepointSet expose it, so that callers testing
+  // many characters can do so without a virtual call per character.
+  // @return the set; NULL if the predicate has none
+  virtual const CodepointSet* codepoint_set() const;
 };
 
 // All characters except for those between [start, end] are rejected
-class AcceptRange : public CharacterPredicate,
-                    public sfntly::RefCounted<AcceptRange> {
+class AcceptRange : public CharacterPredicate {
  public:
   AcceptRange(int32_t start, int32_t end);
   ~AcceptRange();
   virtual bool operator()(int32_t character) const;
+  virtual int64_t CharacterCount() const;
+  virtual void GetCharacters(sfntly::IntegerList* characters) const;
 
  private:
   int32_t start_;
@@ -44,20 +59,36 @@ class AcceptRange : public CharacterPredicate,
 // All characters in IntegerSet
 // The set is OWNED by the predicate! Do not modify it.
 // It will be freed when the predicate is destroyed.
-class AcceptSet : public CharacterPredicate,
-                  public sfntly::RefCounted<AcceptSet> {
+class AcceptSet : public CharacterPredicate {
  public:
   explicit AcceptSet(sfntly::IntegerSet* characters);
   ~AcceptSet();
   virtual bool operator()(int32_t character) const;
+  virtual int64_t CharacterCount() const;
+  virtual void GetCharacters(sfntly::IntegerList* characters) const;
 
  private:
   sfntly::IntegerSet* characters_;
 };
 
+// All characters in a CodepointSet, which the predicate keeps a copy of.
+class AcceptCodepoints : public CharacterPredicate {
+ public:
+  explicit AcceptCodepoints(const CodepointSet& codepoints);
+  explicit AcceptCodepoints(CodepointSet&& codepoints);
+  ~AcceptCodepoints();
+  virtual bool operator()(int32_t character) const;
+  virtual int64_t CharacterCount() const;
+  virtual void GetCharacters(sfntly::IntegerList* characters) const;
+  virtual const CodepointSet* codepoint_set() const;
+
+ private:
+  CodepointSet codepoints_;
+  int64_t count_;
+};
+
 // All characters
-class AcceptAll : public CharacterPredicate,
-                  public sfntly::RefCounted<AcceptAll> {
+class AcceptAll : public CharacterPredicate {
  public:
   AcceptAll() {}
   ~AcceptAll() {}
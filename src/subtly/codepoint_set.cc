@@ -0,0 +1,328 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "subtly/codepoint_set.h"
+
+#if defined (__x86_64__) && (defined (__GNUC__) || defined (__clang__))
+#define SUBTLY_CODEPOINT_SET_X86
+#include <immintrin.h>
+#endif
+
+namespace subtly {
+using namespace sfntly;
+
+namespace {
+
+// Kernels over one 64 byte block of 8 words.
+typedef void (*BlockOperation)(uint64_t* dst, const uint64_t* src);
+typedef int64_t (*BlockCount)(const uint64_t* block);
+
+void OrBlockScalar(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; ++i) {
+    dst[i] |= src[i];
+  }
+}
+
+void AndBlockScalar(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+int64_t CountBlockScalar(const uint64_t* block) {
+  int64_t count = 0;
+  for (int32_t i = 0; i < 8; ++i) {
+    count += __builtin_popcountll(block[i]);
+  }
+  return count;
+}
+
+#if defined (SUBTLY_CODEPOINT_SET_X86)
+
+__attribute__((target("sse2")))
+void OrBlockSSE2(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; i += 2) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(d, _mm_or_si128(_mm_loadu_si128(d),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+  }
+}
+
+__attribute__((target("sse2")))
+void AndBlockSSE2(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; i += 2) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(d, _mm_and_si128(_mm_loadu_si128(d),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+  }
+}
+
+__attribute__((target("avx2")))
+void OrBlockAVX2(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; i += 4) {
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    _mm256_storeu_si256(d, _mm256_or_si256(_mm256_loadu_si256(d),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+  }
+}
+
+__attribute__((target("avx2")))
+void AndBlockAVX2(uint64_t* dst, const uint64_t* src) {
+  for (int32_t i = 0; i < 8; i += 4) {
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    _mm256_storeu_si256(d, _mm256_and_si256(_mm256_loadu_si256(d),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+  }
+}
+
+__attribute__((target("popcnt")))
+int64_t CountBlockPopcnt(const uint64_t* block) {
+  int64_t count = 0;
+  for (int32_t i = 0; i < 8; ++i) {
+    count += _mm_popcnt_u64(block[i]);
+  }
+  return count;
+}
+
+#endif  // SUBTLY_CODEPOINT_SET_X86
+
+struct BlockKernels {
+  BlockOperation or_block;
+  BlockOperation and_block;
+  BlockCount count_block;
+};
+
+BlockKernels SelectKernels() {
+  BlockKernels kernels = { OrBlockScalar, AndBlockScalar, CountBlockScalar };
+#if defined (SUBTLY_CODEPOINT_SET_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.or_block = OrBlockAVX2;
+    kernels.and_block = AndBlockAVX2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    kernels.or_block = OrBlockSSE2;
+    kernels.and_block = AndBlockSSE2;
+  }
+  if (__builtin_cpu_supports("popcnt"))
+    kernels.count_block = CountBlockPopcnt;
+#endif
+  return kernels;
+}
+
+const BlockKernels& Kernels() {
+  // Function local statics are initialized exactly once, even when first
+  // reached from several threads at the same time.
+  static const BlockKernels kernels = SelectKernels();
+  return kernels;
+}
+
+// @return the code point the hexadecimal number names, with an optional U+
+//         prefix; -1 if it is malformed or out of range
+int32_t ParseCodepoint(const std::string& text, size_t start, size_t end) {
+  while (start < end && (text[start] == ' ' || text[start] == '\t'))
+    ++start;
+  while (end > start && (text[end - 1] == ' ' || text[end - 1] == '\t'))
+    --end;
+  if (end - start >= 2 && (text[start] == 'U' || text[start] == 'u') &&
+      text[start + 1] == '+') {
+    start += 2;
+  }
+  if (start == end || end - start > 6)
+    return -1;
+  int32_t codepoint = 0;
+  for (size_t i = start; i < end; ++i) {
+    char c = text[i];
+    int32_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return -1;
+    }
+    codepoint = codepoint * 16 + digit;
+  }
+  return codepoint <= CodepointSet::kMaxCodepoint ? codepoint : -1;
+}
+
+}  // namespace
+
+/******************************************************************************
+ * CodepointSet class
+ ******************************************************************************/
+CodepointSet::CodepointSet()
+    : index_(kNumBlocks, 0),
+      blocks_(1, Block()) {
+}
+
+CodepointSet::Block* CodepointSet::MutableBlock(int32_t codepoint) {
+  uint16_t* entry = &index_[codepoint >> kBlockShift];
+  if (*entry == 0) {
+    *entry = (uint16_t)blocks_.size();
+    blocks_.push_back(Block());
+  }
+  return &blocks_[*entry];
+}
+
+void CodepointSet::Add(int32_t codepoint) {
+  if (codepoint < 0 || codepoint > kMaxCodepoint)
+    return;
+  MutableBlock(codepoint)->words[(codepoint >> 6) & (kWordsPerBlock - 1)] |=
+      (uint64_t)1 << (codepoint & 63);
+}
+
+void CodepointSet::AddRange(int32_t first, int32_t last) {
+  if (first < 0)
+    first = 0;
+  if (last > kMaxCodepoint)
+    last = kMaxCodepoint;
+  // Whole words at a time; only the words at either end are partial.
+  while (first <= last) {
+    int32_t word_last = first | 63;
+    if (word_last > last)
+      word_last = last;
+    uint64_t mask = ~(uint64_t)0 << (first & 63);
+    if ((word_last & 63) != 63)
+      mask &= ((uint64_t)1 << ((word_last & 63) + 1)) - 1;
+    MutableBlock(first)->words[(first >> 6) & (kWordsPerBlock - 1)] |= mask;
+    first = word_last + 1;
+  }
+}
+
+bool CodepointSet::AddUtf8(const uint8_t* text, size_t length) {
+  static const int32_t kMinimum[] = { 0, 0x80, 0x800, 0x10000 };
+  size_t i = 0;
+  while (i < length) {
+    uint8_t lead = text[i];
+    if (lead < 0x80) {
+      Add(lead);
+      ++i;
+      continue;
+    }
+    int32_t codepoint;
+    size_t count;
+    if ((lead & 0xe0) == 0xc0) {
+      codepoint = lead & 0x1f;
+      count = 1;
+    } else if ((lead & 0xf0) == 0xe0) {
+      codepoint = lead & 0x0f;
+      count = 2;
+    } else if ((lead & 0xf8) == 0xf0) {
+      codepoint = lead & 0x07;
+      count = 3;
+    } else {
+      return false;
+    }
+    if (i + count >= length)
+      return false;
+    for (size_t j = 1; j <= count; ++j) {
+      if ((text[i + j] & 0xc0) != 0x80)
+        return false;
+      codepoint = (codepoint << 6) | (text[i + j] & 0x3f);
+    }
+    // Overlong forms, surrogates and values past U+10FFFF are not UTF-8.
+    if (codepoint < kMinimum[count] || codepoint > kMaxCodepoint ||
+        (codepoint >= 0xd800 && codepoint <= 0xdfff)) {
+      return false;
+    }
+    Add(codepoint);
+    i += count + 1;
+  }
+  return true;
+}
+
+bool CodepointSet::AddRanges(const std::string& ranges) {
+  size_t start = 0;
+  while (start <= ranges.size()) {
+    size_t end = ranges.find(',', start);
+    if (end == std::string::npos)
+      end = ranges.size();
+    if (ranges.find_first_not_of(" \t", start) < end) {
+      size_t dash = ranges.find('-', start);
+      if (dash > end)
+        dash = end;
+      int32_t first = ParseCodepoint(ranges, start, dash);
+      int32_t last = dash == end ? first :
+          ParseCodepoint(ranges, dash + 1, end);
+      if (first < 0 || last < first)
+        return false;
+      AddRange(first, last);
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+int64_t CodepointSet::Count() const {
+  BlockCount count_block = Kernels().count_block;
+  int64_t count = 0;
+  for (int32_t i = 0; i < kNumBlocks; ++i) {
+    if (index_[i] != 0)
+      count += count_block(blocks_[index_[i]].words);
+  }
+  return count;
+}
+
+bool CodepointSet::IsEmpty() const {
+  for (int32_t i = 0; i < kNumBlocks; ++i) {
+    if (index_[i] == 0)
+      continue;
+    const Block& block = blocks_[index_[i]];
+    for (int32_t w = 0; w < kWordsPerBlock; ++w) {
+      if (block.words[w])
+        return false;
+    }
+  }
+  return true;
+}
+
+void CodepointSet::Union(const CodepointSet& other) {
+  BlockOperation or_block = Kernels().or_block;
+  for (int32_t i = 0; i < kNumBlocks; ++i) {
+    if (other.index_[i] == 0)
+      continue;
+    if (index_[i] == 0) {
+      index_[i] = (uint16_t)blocks_.size();
+      blocks_.push_back(other.blocks_[other.index_[i]]);
+    } else {
+      or_block(blocks_[index_[i]].words, other.blocks_[other.index_[i]].words);
+    }
+  }
+}
+
+void CodepointSet::Intersect(const CodepointSet& other) {
+  BlockOperation and_block = Kernels().and_block;
+  for (int32_t i = 0; i < kNumBlocks; ++i) {
+    if (index_[i] == 0)
+      continue;
+    if (other.index_[i] == 0) {
+      // The block is dropped from the index; its storage is reused only if
+      // the set is rebuilt.
+      index_[i] = 0;
+    } else {
+      and_block(blocks_[index_[i]].words,
+                other.blocks_[other.index_[i]].words);
+    }
+  }
+}
+
+void CodepointSet::GetCodepoints(IntegerList* codepoints) const {
+  codepoints->reserve(codepoints->size() + (size_t)Count());
+  ForEach([codepoints](int32_t codepoint) {
+    codepoints->push_back(codepoint);
+  });
+}
+}
@@ -0,0 +1,109 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_CODEPOINT_SET_H_
+#define TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_CODEPOINT_SET_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "sfntly/port/type.h"
+
+namespace subtly {
+// A set of Unicode code points stored as a two level bitmap over all 17
+// planes: an index of 2176 entries, one per block of 512 code points, pointing
+// at the block's 512 bits. Blocks without code points share one empty block,
+// so a set costs 4 KB plus 64 bytes per block in use, and Contains is two
+// loads and a shift.
+class CodepointSet {
+ public:
+  static const int32_t kMaxCodepoint = 0x10ffff;
+
+  CodepointSet();
+
+  // Adds a code point; values outside [0, kMaxCodepoint] are ignored.
+  void Add(int32_t codepoint);
+  // Adds [first, last], clamped to [0, kMaxCodepoint].
+  void AddRange(int32_t first, int32_t last);
+  // Adds the code points of UTF-8 text.
+  // @return false if the text is not well formed UTF-8; the code points
+  //         before the error have been added
+  bool AddUtf8(const uint8_t* text, size_t length);
+  // Adds a comma separated list of code points and ranges in Unicode range
+  // syntax, e.g. "U+0041-005A, U+4E00-9FFF, 3000"; the U+ prefix is optional.
+  // @return false if the list is malformed; the items before the error have
+  //         been added
+  bool AddRanges(const std::string& ranges);
+
+  bool Contains(int32_t codepoint) const {
+    if (codepoint < 0 || codepoint > kMaxCodepoint)
+      return false;
+    const Block& block = blocks_[index_[codepoint >> kBlockShift]];
+    return (block.words[(codepoint >> 6) & (kWordsPerBlock - 1)] >>
+            (codepoint & 63)) & 1;
+  }
+  bool operator()(int32_t codepoint) const { return Contains(codepoint); }
+
+  // @return the number of code points in the set
+  int64_t Count() const;
+  bool IsEmpty() const;
+
+  // Adds every code point of other.
+  void Union(const CodepointSet& other);
+  // Removes every code point not in other.
+  void Intersect(const CodepointSet& other);
+
+  // Calls visitor with every code point in increasing order.
+  template <typename Visitor>
+  void ForEach(Visitor visitor) const {
+    for (int32_t i = 0; i < kNumBlocks; ++i) {
+      if (index_[i] == 0)
+        continue;
+      const Block& block = blocks_[index_[i]];
+      for (int32_t w = 0; w < kWordsPerBlock; ++w) {
+        uint64_t word = block.words[w];
+        while (word) {
+          visitor((i << kBlockShift) + w * 64 + __builtin_ctzll(word));
+          word &= word - 1;
+        }
+      }
+    }
+  }
+
+  // Appends the code points in increasing order.
+  void GetCodepoints(sfntly::IntegerList* codepoints) const;
+
+ private:
+  static const int32_t kBlockShift = 9;
+  static const int32_t kWordsPerBlock = 8;
+  static const int32_t kNumBlocks = (kMaxCodepoint >> kBlockShift) + 1;
+
+  // 512 bits, one cache line.
+  struct Block {
+    uint64_t words[kWordsPerBlock];
+  };
+
+  // @return the block holding the code point, allocating it if the code
+  //         point's block is the shared empty one
+  Block* MutableBlock(int32_t codepoint);
+
+  // Block index of each 512 code point range; 0 is the shared empty block.
+  std::vector<uint16_t> index_;
+  std::vector<Block> blocks_;
+};
+}
+
+#endif  // TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_CODEPOINT_SET_H_
@@ -23,8 +23,11 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <set>
 #include <map>
+#include <utility>
+#include <vector>
 
 #include "sfntly/tag.h"
 #include "sfntly/font.h"
@@ -40,6 +43,7 @@
 namespace subtly {
 using namespace sfntly;
 
+const int32_t FontAssembler::kDroppedGlyph        = -1;
 const int32_t FontAssembler::VERSION_2            = 0x20000;
 const int32_t FontAssembler::NUM_STANDARD_NAMES   = 258;
 const int32_t FontAssembler::V1_TABLE_SIZE        = 32;
@@ -70,13 +74,25 @@ const std::unordered_map<std::string, int32_t >*
 
 FontAssembler::FontAssembler(FontInfo* font_info,
                              IntegerSet* table_blacklist)
-    : table_blacklist_(table_blacklist) {
+    : table_blacklist_(table_blacklist),
+      retain_glyph_ids_(false) {
   font_info_ = font_info;
   Initialize();
 }
 
 FontAssembler::FontAssembler(FontInfo* font_info)
-    : table_blacklist_(NULL) {
+    : table_blacklist_(NULL),
+      retain_glyph_ids_(false) {
+  font_info_ = font_info;
+  Initialize();
+}
+
+FontAssembler::FontAssembler(FontInfo* font_info,
+                             IntegerSet* table_blacklist,
+                             PreparedFont* prepared_font)
+    : table_blacklist_(table_blacklist),
+      retain_glyph_ids_(false),
+      prepared_font_(prepared_font) {
   font_info_ = font_info;
   Initialize();
 }
@@ -94,6 +110,7 @@ CALLER_ATTACH Font* FontAssembler::Assemble() {
     return NULL;
   }
   // For all other tables, either include them unmodified or don't at all.
+  // The tables assembled above keep their builders.
   const TableMap* common_table_map =
       font_info_->GetTableMap(font_info_->fonts()->begin()->first);
   for (TableMap::const_iterator it = common_table_map->begin(),
@@ -102,7 +119,7 @@ CALLER_ATTACH Font* FontAssembler::Assemble() {
         && table_blacklist_->find(it->first) != table_blacklist_->end()) {
       continue;
     }
-    font_builder_->NewTableBuilder(it->first, it->second->ReadFontData());
+    font_builder_->NewTableBuilder(it->second.p_);
   }
   return font_builder_->Build();
 }
@@ -122,11 +139,13 @@ bool FontAssembler::AssembleCMapTable() {
     return false;
   // Creating the segments and the glyph id array
   CharacterMap* chars_to_glyph_ids = font_info_->chars_to_glyph_ids();
-  SegmentList* segment_list = new SegmentList;
-  IntegerList* new_glyph_id_array = new IntegerList;
+  SegmentList segment_list;
+  IntegerList new_glyph_id_array;
   int32_t last_chararacter = -2;
   int32_t last_offset = 0;
+  int32_t num_old_glyphids = (int32_t)old_to_new_glyphid_.size();
   Ptr<CMapTable::CMapFormat4::Builder::Segment> current_segment;
+  new_glyph_id_array.reserve(chars_to_glyph_ids->size() + 1);
 
   // For simplicity, we will have one segment per contiguous range.
   // To test the algorithm, we've replaced the original CMap with the CMap
@@ -139,7 +158,7 @@ bool FontAssembler::AssembleCMapTable() {
     if (character != last_chararacter + 1) {  // new segment
       if (current_segment != NULL) {
         current_segment->set_end_count(last_chararacter);
-        segment_list->push_back(current_segment);
+        segment_list.push_back(std::move(current_segment));
       }
       // start_code = character
       // end_code = -1 (unknown for now)
@@ -150,31 +169,31 @@ bool FontAssembler::AssembleCMapTable() {
           Segment(character, -1, 0, last_offset);
     }
     int32_t old_glyphid = it->second.glyph_id();
-    new_glyph_id_array->push_back(old_to_new_glyphid_[old_glyphid]);
+    new_glyph_id_array.push_back(
+        old_glyphid >= 0 && old_glyphid < num_old_glyphids ?
+        old_to_new_glyphid_[old_glyphid] : 0);
     last_offset += DataSize::kSHORT;
     last_chararacter = character;
   }
   // The last segment is still open.
   if (current_segment != NULL){
       current_segment->set_end_count(last_chararacter);
-      segment_list->push_back(current_segment);
+      segment_list.push_back(std::move(current_segment));
   }
   // Updating the id_range_offset for every segment.
-  for (int32_t i = 0, num_segs = segment_list->size(); i < num_segs; ++i) {
-    Ptr<CMapTable::CMapFormat4::Builder::Segment> segment = segment_list->at(i);
+  for (int32_t i = 0, num_segs = segment_list.size(); i < num_segs; ++i) {
+    CMapTable::CMapFormat4::Builder::Segment* segment = segment_list[i];
     segment->set_id_range_offset(segment->id_range_offset()
                                  + (num_segs - i + 1) * DataSize::kSHORT);
   }
   // Adding the final, required segment.
   current_segment =
       new CMapTable::CMapFormat4::Builder::Segment(0xffff, 0xffff, 1, 0);
-  new_glyph_id_array->push_back(0);//边界处理
-  segment_list->push_back(current_segment);
-  // Writing the segments and glyph id array to the CMap
-  cmap_builder->set_segments(segment_list);
-  cmap_builder->set_glyph_id_array(new_glyph_id_array);
-  delete segment_list;
-  delete new_glyph_id_array;
+  new_glyph_id_array.push_back(0);//边界处理
+  segment_list.push_back(std::move(current_segment));
+  // Handing the segments and glyph id array over to the CMap
+  cmap_builder->set_segments(std::move(segment_list));
+  cmap_builder->set_glyph_id_array(std::move(new_glyph_id_array));
   return true;
 }
 
@@ -182,9 +201,6 @@ bool FontAssembler::AssembleGlyphAndLocaTables() {
   Ptr<LocaTable::Builder> loca_table_builder =
       down_cast<LocaTable::Builder*>
       (font_builder_->NewTableBuilder(Tag::loca));
-  Ptr<GlyphTable::Builder> glyph_table_builder =
-      down_cast<GlyphTable::Builder*>
-      (font_builder_->NewTableBuilder(Tag::glyf));
 
   GlyphIdSet* resolved_glyph_ids = font_info_->resolved_glyph_ids();
   // Basic sanity check: all LOCA tables are of the same size
@@ -201,70 +217,172 @@ bool FontAssembler::AssembleGlyphAndLocaTables() {
     previous_size = current_size;
   }
 
-  GlyphTable::GlyphBuilderList* glyph_builders =
-      glyph_table_builder->GlyphBuilders();
-
+  // The glyphs are written back to back in glyph id order, so the new loca
+  // offsets are running sums of the glyph lengths and the glyf table's size
+  // is known before anything is copied.
+  // The glyph ids are sorted, so the last one bounds the remap table.
+  int32_t last_glyph_id = resolved_glyph_ids->empty() ? -1 :
+                          resolved_glyph_ids->back().glyph_id();
+  int32_t num_new_glyphs = (int32_t)resolved_glyph_ids->size();
+  if (retain_glyph_ids_) {
+    // Every subset of a font gets all of its glyph ids, so that subsets share
+    // one numbering; cmap entries keep their glyph ids.
+    num_new_glyphs = std::max(last_glyph_id + 1, NumSourceGlyphs());
+    old_to_new_glyphid_.resize(num_new_glyphs);
+    for (int32_t i = 0; i < num_new_glyphs; ++i) {
+      old_to_new_glyphid_[i] = i;
+    }
+  } else {
+    old_to_new_glyphid_.assign(last_glyph_id + 1, 0);
+  }
+  new_to_old_glyphid_.reserve(num_new_glyphs);
+  std::vector<FontDataSpan> glyphs;
+  glyphs.reserve(num_new_glyphs);
+  IntegerList loca_list;
+  loca_list.reserve(num_new_glyphs + 1);
+  loca_list.push_back(0);
+  FontId current_font_id = -1;
+  Ptr<LocaTable> loca_table;
+  FontDataSpan glyf_data;
   int32_t new_glyphid = 0;
   for (GlyphIdSet::iterator it = resolved_glyph_ids->begin(),
            e = resolved_glyph_ids->end(); it != e; ++it) {
     // Get the glyph for this resolved_glyph_id.
     int32_t resolved_glyph_id = it->glyph_id();
+    if (retain_glyph_ids_) {
+      // The glyphs dropped before this one stay in place, empty.
+      AddDroppedGlyphs(resolved_glyph_id - new_glyphid, &glyphs, &loca_list);
+      new_glyphid = resolved_glyph_id;
+    }
     old_to_new_glyphid_[resolved_glyph_id] = new_glyphid++;
     new_to_old_glyphid_.push_back(resolved_glyph_id);
-    int32_t font_id = it->font_id();
-    // Get the LOCA table for the current glyph id.
-    Ptr<LocaTable> loca_table =
-        down_cast<LocaTable*>
-        (font_info_->GetTable(font_id, Tag::loca));
-    int32_t length = loca_table->GlyphLength(resolved_glyph_id);
-    int32_t offset = loca_table->GlyphOffset(resolved_glyph_id);
-
-    // Get the GLYF table for the current glyph id.
-    Ptr<GlyphTable> glyph_table =
-        down_cast<GlyphTable*>
-        (font_info_->GetTable(font_id, Tag::glyf));
-    GlyphPtr glyph;
-    glyph.Attach(glyph_table->GetGlyph(offset, length));
-
-    // The data reference by the glyph is copied into a new glyph and
-    // added to the glyph_builders belonging to the glyph_table_builder.
-    // When Build gets called, all the glyphs will be built.
-    // TODO（veaxen）这里需要考虑下glyphid是kComposite的情况
-    Ptr<ReadableFontData> data = glyph->ReadFontData();
-    Ptr<WritableFontData> copy_data;
-    copy_data.Attach(WritableFontData::CreateWritableFontData(data->Length()));
-    data->CopyTo(copy_data);
-    GlyphBuilderPtr glyph_builder;
-    glyph_builder.Attach(glyph_table_builder->GlyphBuilder(copy_data));
-    glyph_builders->push_back(glyph_builder);
+    FontDataSpan glyph;
+    if (prepared_font_) {
+      glyph = prepared_font_->GlyphData(resolved_glyph_id);
+    } else {
+      // Get the LOCA and GLYF tables of the font the glyph comes from; runs
+      // of glyphs from one font look them up once.
+      if (it->font_id() != current_font_id) {
+        current_font_id = it->font_id();
+        loca_table = down_cast<LocaTable*>
+            (font_info_->GetTable(current_font_id, Tag::loca));
+        Ptr<GlyphTable> glyph_table = down_cast<GlyphTable*>
+            (font_info_->GetTable(current_font_id, Tag::glyf));
+        glyf_data = glyph_table->ReadFontData()->Span();
+      }
+      int32_t length = loca_table->GlyphLength(resolved_glyph_id);
+      int32_t offset = loca_table->GlyphOffset(resolved_glyph_id);
+      glyph = glyf_data.Subspan(offset, length);
+    }
+    // A glyph whose loca entries point outside the glyf table becomes empty.
+    glyphs.push_back(glyph);
+    loca_list.push_back(loca_list.back() + glyph.length());
   }
-
-  IntegerList loca_list;
-  glyph_table_builder->GenerateLocaList(&loca_list);
+  AddDroppedGlyphs(num_new_glyphs - new_glyphid, &glyphs, &loca_list);
+
+  // Copy the glyph bytes straight from the source glyf data. Glyphs that lie
+  // back to back in the source, as consecutive glyph ids usually do, are
+  // copied together, so a run of kept glyphs costs a single copy.
+  WritableFontDataPtr glyf;
+  glyf.Attach(WritableFontData::CreateWritableFontData(loca_list.back()));
+  int32_t run_offset = 0;
+  for (size_t i = 0; i < glyphs.size();) {
+    const uint8_t* run_start = glyphs[i].data();
+    int32_t run_length = glyphs[i].length();
+    for (++i; i < glyphs.size() &&
+              glyphs[i].data() == run_start + run_length; ++i) {
+      run_length += glyphs[i].length();
+    }
+    if (run_length > 0) {
+      glyf->WriteBytes(run_offset, const_cast<uint8_t*>(run_start), 0,
+                       run_length);
+    }
+    run_offset += run_length;
+  }
+  font_builder_->NewTableBuilder(Tag::glyf, std::move(glyf));
   loca_table_builder->SetLocaList(&loca_list);
 
-  Ptr<ReadableFontData> rFontData = font_info_->GetTable(font_info_->fonts()->begin()->first, Tag::maxp)->ReadFontData();
-  font_builder_->NewTableBuilder(Tag::maxp, rFontData);
+  Table* maxp_table = down_cast<Table*>(font_info_->GetTable(
+      font_info_->fonts()->begin()->first, Tag::maxp));
+  if (!maxp_table)
+    return false;
+  font_builder_->NewTableBuilder(maxp_table);
   MaximumProfileTableBuilderPtr maxpBuilder =
           down_cast<MaximumProfileTable::Builder*>(font_builder_->GetTableBuilder(Tag::maxp));
   maxpBuilder->SetNumGlyphs(loca_table_builder->NumGlyphs());
   return true;
 }
 
+void FontAssembler::AddDroppedGlyphs(int32_t count,
+                                     std::vector<FontDataSpan>* glyphs,
+                                     IntegerList* loca_list) {
+  for (int32_t i = 0; i < count; ++i) {
+    new_to_old_glyphid_.push_back(kDroppedGlyph);
+    glyphs->push_back(FontDataSpan());
+    loca_list->push_back(loca_list->back());
+  }
+}
+
+int32_t FontAssembler::NumSourceGlyphs() {
+  if (prepared_font_)
+    return prepared_font_->num_glyphs();
+  Ptr<LocaTable> loca_table = down_cast<LocaTable*>(font_info_->GetTable(
+      font_info_->fonts()->begin()->first, Tag::loca));
+  return loca_table ? loca_table->num_glyphs() : 0;
+}
+
 struct LongHorMetric{
     int32_t advanceWidth;
     int32_t lsb;
 };
 bool FontAssembler::AssembleHorizontalMetricsTable() {
-  HorizontalMetricsTablePtr origMetrics =
-          down_cast<HorizontalMetricsTable*>(font_info_->GetTable(0, Tag::hmtx));
-  if (origMetrics == NULL) {
-    return false;
+  std::vector<LongHorMetric> metrics;
+  metrics.reserve(new_to_old_glyphid_.size());
+  if (prepared_font_) {
+    if (!prepared_font_->has_metrics()) {
+      return false;
+    }
+    for (size_t i = 0; i < new_to_old_glyphid_.size(); ++i) {
+      int32_t origGlyphId = new_to_old_glyphid_[i];
+      if (origGlyphId == kDroppedGlyph) {
+        metrics.push_back(LongHorMetric{0, 0});
+        continue;
+      }
+      metrics.push_back(LongHorMetric{
+          prepared_font_->AdvanceWidth(origGlyphId),
+          prepared_font_->LeftSideBearing(origGlyphId)});
+    }
   }
 
-  std::vector<LongHorMetric> metrics;
-  for (size_t i = 0; i < new_to_old_glyphid_.size(); ++i) {
+  HorizontalMetricsTablePtr origMetrics;
+  if (!prepared_font_) {
+    origMetrics =
+        down_cast<HorizontalMetricsTable*>(font_info_->GetTable(0, Tag::hmtx));
+    if (origMetrics == NULL) {
+      return false;
+    }
+  }
+
+  // Decode the original metrics in bulk; glyphs outside the decoded range
+  // (or a truncated table) fall back to the per-glyph accessors.
+  std::vector<int32_t> origAdvanceWidths;
+  std::vector<int32_t> origLsbs;
+  if (origMetrics) {
+    origMetrics->Metrics(&origAdvanceWidths, &origLsbs);
+  }
+  int32_t numOrigMetrics = (int32_t)origAdvanceWidths.size();
+
+  for (size_t i = 0; origMetrics && i < new_to_old_glyphid_.size(); ++i) {
     int32_t origGlyphId = new_to_old_glyphid_[i];
+    if (origGlyphId == kDroppedGlyph) {
+      metrics.push_back(LongHorMetric{0, 0});
+      continue;
+    }
+    if (origGlyphId >= 0 && origGlyphId < numOrigMetrics) {
+      metrics.push_back(LongHorMetric{origAdvanceWidths[origGlyphId],
+                                      origLsbs[origGlyphId]});
+      continue;
+    }
     int32_t advanceWidth = origMetrics->AdvanceWidth(origGlyphId);
     int32_t lsb = origMetrics->LeftSideBearing(origGlyphId);
     metrics.push_back(LongHorMetric{advanceWidth, lsb});
@@ -278,20 +396,25 @@ bool FontAssembler::AssembleHorizontalMetricsTable() {
   int32_t size = 4 * numberOfHMetrics + 2 * ((int32_t)metrics.size() - numberOfHMetrics);
   WritableFontDataPtr data;
   data.Attach(WritableFontData::CreateWritableFontData(size));
-  int32_t index = 0;
+  // hMetrics are (advanceWidth, lsb) pairs followed by the bare lsbs; lay them
+  // out as one run of USHORTs and write it in bulk.
+  int32_t nMetric = (int32_t)metrics.size();
+  std::vector<uint16_t> hmtx(numberOfHMetrics + nMetric);
   int32_t advanceWidthMax = 0;
+  int32_t pos = 0;
   for (int32_t i=0; i < numberOfHMetrics; ++i) {
     int32_t adw = metrics[i].advanceWidth;
     advanceWidthMax = std::max(adw, advanceWidthMax);
-    index += data->WriteUShort(index, adw);
-    index += data->WriteShort(index, metrics[i].lsb);
+    hmtx[pos++] = (uint16_t)adw;
+    hmtx[pos++] = (uint16_t)metrics[i].lsb;
   }
-  int32_t nMetric = (int32_t)metrics.size();
   for (int32_t j = numberOfHMetrics; j < nMetric; ++j) {
-    index += data->WriteShort(index, metrics[j].lsb);
+    hmtx[pos++] = (uint16_t)metrics[j].lsb;
   }
-  font_builder_->NewTableBuilder(Tag::hmtx, data);
-  font_builder_->NewTableBuilder(Tag::hhea, font_info_->GetTable(0, Tag::hhea)->ReadFontData());
+  data->WriteUShortArray(0, &hmtx[0], (int32_t)hmtx.size());
+  font_builder_->NewTableBuilder(Tag::hmtx, std::move(data));
+  font_builder_->NewTableBuilder(
+      down_cast<Table*>(font_info_->GetTable(0, Tag::hhea)));
   HorizontalHeaderTableBuilderPtr hheaBuilder =
           down_cast<HorizontalHeaderTable::Builder*>(font_builder_->GetTableBuilder(Tag::hhea));
   hheaBuilder->SetNumberOfHMetrics(numberOfHMetrics);
@@ -317,12 +440,20 @@ bool FontAssembler::AssemblePostScriptTabble() {
   std::vector<std::string> names;
   if (post_version == 0x10000 || post_version == 0x20000) {
     for (size_t i = 0; i < new_to_old_glyphid_.size(); ++i) {
-      names.push_back(post->GlyphName(new_to_old_glyphid_[i]));
+      int32_t origGlyphId = new_to_old_glyphid_[i];
+      if (origGlyphId == kDroppedGlyph) {
+        // A standard name, so that dropped glyphs add nothing to the names.
+        names.push_back(PostScriptTable::STANDARD_NAMES[0]);
+        continue;
+      }
+      names.push_back(prepared_font_ ?
+                      prepared_font_->GlyphName(origGlyphId) :
+                      post->GlyphName(origGlyphId));
     }
   }
 
   if (names.empty()){
-      font_builder_->NewTableBuilder(Tag::post, v1Data);
+      font_builder_->NewTableBuilder(Tag::post, std::move(v1Data));
       return true;
   }
 
@@ -360,7 +491,7 @@ bool FontAssembler::AssemblePostScriptTabble() {
     data->WriteBytes(index, &nameBytes);
   }
 
-  font_builder_->NewTableBuilder(Tag::post, data);
+  font_builder_->NewTableBuilder(Tag::post, std::move(data));
   return true;
 }
 }
@@ -19,9 +19,12 @@
 
 #include <set>
 #include <map>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "subtly/font_info.h"
+#include "subtly/prepared_font.h"
 
 #include "sfntly/tag.h"
 #include "sfntly/font.h"
@@ -41,6 +44,10 @@ class FontAssembler : public sfntly::RefCounted<FontAssembler> {
   // final font.
   FontAssembler(FontInfo* font_info, sfntly::IntegerSet* table_blacklist);
   explicit FontAssembler(FontInfo* font_info);
+  // As above, but glyph data, metrics and glyph names are read from
+  // prepared_font, which must have produced font_info.
+  FontAssembler(FontInfo* font_info, sfntly::IntegerSet* table_blacklist,
+                PreparedFont* prepared_font);
   ~FontAssembler() { }
 
   // Assemble a new font from the font info object.
@@ -50,6 +57,15 @@ class FontAssembler : public sfntly::RefCounted<FontAssembler> {
   void set_table_blacklist(sfntly::IntegerSet* table_blacklist) {
     table_blacklist_ = table_blacklist;
   }
+  // When set, glyphs keep their ids instead of being numbered densely: the
+  // glyphs that are not kept stay in the font as empty glyphs with zero
+  // metrics, up to the source font's glyph count. Every subset of a font then
+  // shares its glyph numbering and loca/hmtx layout, and glyph ids need no
+  // remapping by whoever embeds the subset.
+  bool retain_glyph_ids() const { return retain_glyph_ids_; }
+  void set_retain_glyph_ids(bool retain_glyph_ids) {
+    retain_glyph_ids_ = retain_glyph_ids;
+  }
 
  protected:
   virtual bool AssembleCMapTable();
@@ -60,13 +76,26 @@ class FontAssembler : public sfntly::RefCounted<FontAssembler> {
   virtual void Initialize();
 
  private:
+  // Appends count empty glyphs standing in for glyphs that are not kept.
+  void AddDroppedGlyphs(int32_t count,
+                        std::vector<sfntly::FontDataSpan>* glyphs,
+                        sfntly::IntegerList* loca_list);
+  // @return the number of glyphs of the (first) source font
+  int32_t NumSourceGlyphs();
+
   sfntly::Ptr<FontInfo> font_info_;
   sfntly::Ptr<sfntly::FontFactory> font_factory_;
   sfntly::Ptr<sfntly::Font::Builder> font_builder_;
   sfntly::IntegerSet* table_blacklist_;
-  std::map<int32_t, int32_t > old_to_new_glyphid_;
+  bool retain_glyph_ids_;
+  sfntly::Ptr<PreparedFont> prepared_font_;
+  // Indexed by old glyph id up to the largest one kept; glyphs that are not
+  // kept map to 0, .notdef, unless glyph ids are retained.
+  sfntly::IntegerList old_to_new_glyphid_;
+  // kDroppedGlyph for the empty glyphs kept in place of dropped ones.
   sfntly::IntegerList new_to_old_glyphid_;
 
+  static const int32_t kDroppedGlyph;
   static const int32_t VERSION_2;
   static const int32_t NUM_STANDARD_NAMES;
   static const int32_t V1_TABLE_SIZE;
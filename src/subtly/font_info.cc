@@ -18,8 +18,10 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <set>
 #include <map>
+#include <utility>
 
 #include "subtly/character_predicate.h"
 
@@ -51,64 +53,117 @@ bool GlyphId::operator<(const GlyphId& other) const {
   return glyph_id_ < other.glyph_id();
 }
 
+/******************************************************************************
+ * CharacterMap and GlyphIdSet
+ ******************************************************************************/
+namespace {
+
+bool CharacterLess(const std::pair<int32_t, GlyphId>& a,
+                   const std::pair<int32_t, GlyphId>& b) {
+  return a.first < b.first;
+}
+
+bool SameCharacter(const std::pair<int32_t, GlyphId>& a,
+                   const std::pair<int32_t, GlyphId>& b) {
+  return a.first == b.first;
+}
+
+bool CharacterNotBefore(const std::pair<int32_t, GlyphId>& a,
+                        const std::pair<int32_t, GlyphId>& b) {
+  return a.first >= b.first;
+}
+
+bool GlyphIdNotBefore(const GlyphId& a, const GlyphId& b) {
+  return !(a < b);
+}
+
+}  // namespace
+
+void SortCharacterMap(CharacterMap* chars_to_glyph_ids) {
+  // Usually filled in character order already; that costs one pass.
+  if (std::adjacent_find(chars_to_glyph_ids->begin(),
+                         chars_to_glyph_ids->end(), CharacterNotBefore)
+      == chars_to_glyph_ids->end()) {
+    return;
+  }
+  std::stable_sort(chars_to_glyph_ids->begin(), chars_to_glyph_ids->end(),
+                   CharacterLess);
+  chars_to_glyph_ids->erase(std::unique(chars_to_glyph_ids->begin(),
+                                        chars_to_glyph_ids->end(),
+                                        SameCharacter),
+                            chars_to_glyph_ids->end());
+}
+
+void SortGlyphIdSet(GlyphIdSet* glyph_ids) {
+  if (std::adjacent_find(glyph_ids->begin(), glyph_ids->end(),
+                         GlyphIdNotBefore) == glyph_ids->end()) {
+    return;
+  }
+  std::stable_sort(glyph_ids->begin(), glyph_ids->end());
+  glyph_ids->erase(std::unique(glyph_ids->begin(), glyph_ids->end()),
+                   glyph_ids->end());
+}
+
 /******************************************************************************
  * FontInfo class
  ******************************************************************************/
-FontInfo::FontInfo()
-    : chars_to_glyph_ids_(new CharacterMap),
-      resolved_glyph_ids_(new GlyphIdSet),
-      fonts_(new FontIdMap) {
+FontInfo::FontInfo() {
 }
 
 FontInfo::FontInfo(CharacterMap* chars_to_glyph_ids,
                    GlyphIdSet* resolved_glyph_ids,
-                   FontIdMap* fonts) {
-  chars_to_glyph_ids_ = new CharacterMap(chars_to_glyph_ids->begin(),
-                                         chars_to_glyph_ids->end());
-  resolved_glyph_ids_ = new GlyphIdSet(resolved_glyph_ids->begin(),
-                                       resolved_glyph_ids->end());
-  fonts_ = new FontIdMap(fonts->begin(), fonts->end());
+                   FontIdMap* fonts)
+    : chars_to_glyph_ids_(*chars_to_glyph_ids),
+      resolved_glyph_ids_(*resolved_glyph_ids),
+      fonts_(*fonts) {
 }
 
 FontInfo::~FontInfo() {
-  delete chars_to_glyph_ids_;
-  delete resolved_glyph_ids_;
-  delete fonts_;
 }
 
 FontDataTable* FontInfo::GetTable(FontId font_id, int32_t tag) {
-  if (!fonts_)
-    return NULL;
-  FontIdMap::iterator it = fonts_->find(font_id);
-  if (it == fonts_->end())
+  FontIdMap::iterator it = fonts_.find(font_id);
+  if (it == fonts_.end())
     return NULL;
   return it->second->GetTable(tag);
 }
 
 const TableMap* FontInfo::GetTableMap(FontId font_id) {
-  if (!fonts_)
-    return NULL;
-  FontIdMap::iterator it = fonts_->find(font_id);
-  if (it == fonts_->end())
+  FontIdMap::iterator it = fonts_.find(font_id);
+  if (it == fonts_.end())
     return NULL;
   return it->second->GetTableMap();
 }
 
 void FontInfo::set_chars_to_glyph_ids(CharacterMap* chars_to_glyph_ids) {
-  *chars_to_glyph_ids_ = *chars_to_glyph_ids;
+  chars_to_glyph_ids_ = *chars_to_glyph_ids;
 }
 
 void FontInfo::set_resolved_glyph_ids(GlyphIdSet* resolved_glyph_ids) {
-  *resolved_glyph_ids_ = *resolved_glyph_ids;
+  resolved_glyph_ids_ = *resolved_glyph_ids;
 }
 
 void FontInfo::set_fonts(FontIdMap* fonts) {
-  *fonts_ = *fonts;
+  fonts_ = *fonts;
+}
+
+void FontInfo::set_chars_to_glyph_ids(CharacterMap&& chars_to_glyph_ids) {
+  chars_to_glyph_ids_ = std::move(chars_to_glyph_ids);
+}
+
+void FontInfo::set_resolved_glyph_ids(GlyphIdSet&& resolved_glyph_ids) {
+  resolved_glyph_ids_ = std::move(resolved_glyph_ids);
+}
+
+void FontInfo::set_fonts(FontIdMap&& fonts) {
+  fonts_ = std::move(fonts);
 }
 
 /******************************************************************************
  * FontSourcedInfoBuilder class
  ******************************************************************************/
+const int64_t FontSourcedInfoBuilder::kMaxLookedUpCharacters = 0x10000;
+
 FontSourcedInfoBuilder::FontSourcedInfoBuilder(Font* font, FontId font_id)
     : font_(font),
       font_id_(font_id),
@@ -138,34 +193,28 @@ void FontSourcedInfoBuilder::Initialize() {
 }
 
 CALLER_ATTACH FontInfo* FontSourcedInfoBuilder::GetFontInfo() {
-  CharacterMap* chars_to_glyph_ids = new CharacterMap;
-  bool success = GetCharacterMap(chars_to_glyph_ids);
+  CharacterMap chars_to_glyph_ids;
+  bool success = GetCharacterMap(&chars_to_glyph_ids);
   if (!success) {
-    delete chars_to_glyph_ids;
 #if defined (SUBTLY_DEBUG)
     fprintf(stderr, "Error creating character map.\n");
 #endif
     return NULL;
   }
-  GlyphIdSet* resolved_glyph_ids = new GlyphIdSet;
-  success = ResolveCompositeGlyphs(chars_to_glyph_ids, resolved_glyph_ids);
+  GlyphIdSet resolved_glyph_ids;
+  success = ResolveCompositeGlyphs(&chars_to_glyph_ids, &resolved_glyph_ids);
   if (!success) {
-    delete chars_to_glyph_ids;
-    delete resolved_glyph_ids;
 #if defined (SUBTLY_DEBUG)
     fprintf(stderr, "Error resolving composite glyphs.\n");
 #endif
     return NULL;
   }
   Ptr<FontInfo> font_info = new FontInfo;
-  font_info->set_chars_to_glyph_ids(chars_to_glyph_ids);
-  font_info->set_resolved_glyph_ids(resolved_glyph_ids);
-  FontIdMap* font_id_map = new FontIdMap;
-  font_id_map->insert(std::make_pair(font_id_, font_));
-  font_info->set_fonts(font_id_map);
-  delete chars_to_glyph_ids;
-  delete resolved_glyph_ids;
-  delete font_id_map;
+  font_info->set_chars_to_glyph_ids(std::move(chars_to_glyph_ids));
+  font_info->set_resolved_glyph_ids(std::move(resolved_glyph_ids));
+  FontIdMap font_id_map;
+  font_id_map.insert(std::make_pair(font_id_, font_));
+  font_info->set_fonts(std::move(font_id_map));
   return font_info.Detach();
 }
 
@@ -173,84 +222,121 @@ bool FontSourcedInfoBuilder::GetCharacterMap(CharacterMap* chars_to_glyph_ids) {
   if (!cmap_ || !chars_to_glyph_ids)
     return false;
   chars_to_glyph_ids->clear();
-  CMapTable::CMap::CharacterIterator* character_iterator = cmap_->Iterator();
-  if (!character_iterator)
-    return false;
-  while (character_iterator->HasNext()) {
-    int32_t character = character_iterator->Next();
-    if (!predicate_ || (*predicate_)(character)) {
-      chars_to_glyph_ids->insert
-          (std::make_pair(character,
-                          GlyphId(cmap_->GlyphId(character), font_id_)));
+  const CodepointSet* codepoint_set =
+      predicate_ ? predicate_->codepoint_set() : NULL;
+  // A predicate listing a modest number of characters is answered by looking
+  // up each of them; anything else is tested against every cmap character.
+  int64_t character_count = predicate_ ? predicate_->CharacterCount() : -1;
+  if (character_count >= 0 && character_count <= kMaxLookedUpCharacters) {
+    if (codepoint_set) {
+      codepoint_set->ForEach([this, chars_to_glyph_ids](int32_t character) {
+        AddMappedCharacter(character, chars_to_glyph_ids);
+      });
+    } else {
+      IntegerList characters;
+      predicate_->GetCharacters(&characters);
+      for (IntegerList::iterator it = characters.begin(), e = characters.end();
+           it != e; ++it) {
+        AddMappedCharacter(*it, chars_to_glyph_ids);
+      }
     }
+  } else if (codepoint_set) {
+    if (!FilterCharacterMap(*codepoint_set, chars_to_glyph_ids))
+      return false;
+  } else if (!FilterCharacterMap(PredicateRef(predicate_),
+                                 chars_to_glyph_ids)) {
+    return false;
   }
-  delete character_iterator;
+  // Neither a predicate's list nor every cmap iterator is ordered.
+  SortCharacterMap(chars_to_glyph_ids);
   return true;
 }
 
+void FontSourcedInfoBuilder::AddMappedCharacter(
+    int32_t character, CharacterMap* chars_to_glyph_ids) {
+  if (cmap_->Contains(character)) {
+    chars_to_glyph_ids->push_back
+        (std::make_pair(character,
+                        GlyphId(cmap_->GlyphId(character), font_id_)));
+  }
+}
+
 bool
 FontSourcedInfoBuilder::ResolveCompositeGlyphs(CharacterMap* chars_to_glyph_ids,
                                                GlyphIdSet* resolved_glyph_ids) {
   if (!chars_to_glyph_ids || !resolved_glyph_ids)
     return false;
   resolved_glyph_ids->clear();
-  resolved_glyph_ids->insert(GlyphId(0, font_id_));
-  IntegerSet* unresolved_glyph_ids = new IntegerSet;
   // Since composite glyph elements might themselves be composite, we would need
-  // to recursively resolve the elements too. To avoid the recursion we
-  // create two sets, |unresolved_glyph_ids| for the unresolved glyphs,
-  // initially containing all the ids and |resolved_glyph_ids|, initially empty.
-  // We'll remove glyph ids from |unresolved_glyph_ids| until it is empty and,
-  // if the glyph is composite, add its elements to the unresolved set.
+  // to recursively resolve the elements too. To avoid the recursion we keep a
+  // stack of |unresolved_glyph_ids|, initially holding every mapped glyph, and
+  // pop glyphs off it until it is empty, pushing the elements of composite
+  // glyphs. |visited| has a bit per glyph id so that no glyph is pushed
+  // twice; glyph 0 is always kept, but its elements are only followed when a
+  // character maps to it.
+  int32_t num_glyphs = loca_table_->num_glyphs();
+  if (num_glyphs <= 0) {
+    // A corrupt maxp or loca; there is nothing to walk, and no bitset to size.
+    resolved_glyph_ids->push_back(GlyphId(0, font_id_));
+    return true;
+  }
+  std::vector<bool> visited(num_glyphs + 1, false);
+  IntegerList unresolved_glyph_ids;
   for (CharacterMap::iterator it = chars_to_glyph_ids->begin(),
            e = chars_to_glyph_ids->end(); it != e; ++it) {
-    unresolved_glyph_ids->insert(it->second.glyph_id());
-  }
-  // As long as there are unresolved glyph ids.
-  while (!unresolved_glyph_ids->empty()) {
-    // Get the corresponding glyph.
-    int32_t glyph_id = *(unresolved_glyph_ids->begin());
-    unresolved_glyph_ids->erase(unresolved_glyph_ids->begin());
-    if (glyph_id < 0 || glyph_id > loca_table_->num_glyphs()) {
+    int32_t glyph_id = it->second.glyph_id();
+    if (glyph_id < 0 || glyph_id > num_glyphs) {
 #if defined (SUBTLY_DEBUG)
       fprintf(stderr, "%d larger than %d or smaller than 0\n", glyph_id,
-              loca_table_->num_glyphs());
+              num_glyphs);
 #endif
       continue;
     }
+    if (!visited[glyph_id]) {
+      visited[glyph_id] = true;
+      unresolved_glyph_ids.push_back(glyph_id);
+    }
+  }
+  visited[0] = true;
+  IntegerList resolved_ids(1, 0);
+  ReadableFontDataPtr glyf = glyph_table_->ReadFontData();
+  FontDataSpan glyf_data = glyf->Span();
+  // As long as there are unresolved glyph ids.
+  while (!unresolved_glyph_ids.empty()) {
+    // Get the corresponding glyph.
+    int32_t glyph_id = unresolved_glyph_ids.back();
+    unresolved_glyph_ids.pop_back();
     int32_t length = loca_table_->GlyphLength(glyph_id);
-//    if (length == 0) {
-//#if defined (SUBTLY_DEBUG)
-//      fprintf(stderr, "Zero length glyph %d\n", glyph_id);
-//#endif
-//      continue;
-//    }
     int32_t offset = loca_table_->GlyphOffset(glyph_id);
-    GlyphPtr glyph;
-    glyph.Attach(glyph_table_->GetGlyph(offset, length));
-    if (glyph == NULL) {
+    // Read the glyph straight out of the glyf data instead of slicing it into
+    // a GlyphTable::Glyph; this allocates nothing per glyph.
+    FontDataSpan glyph = glyf_data.Subspan(offset, length);
+    if (!glyph.IsValid()) {
 #if defined (SUBTLY_DEBUG)
-      fprintf(stderr, "GetGlyph returned NULL for %d\n", glyph_id);
+      fprintf(stderr, "Glyph data out of bounds for %d\n", glyph_id);
 #endif
       continue;
     }
-    // Mark the glyph as resolved.
-    resolved_glyph_ids->insert(GlyphId(glyph_id, font_id_));
-    // If it is composite, add all its components to the unresolved glyph set.
-    if (glyph->GlyphType() == GlyphType::kComposite) {
-      Ptr<GlyphTable::CompositeGlyph> composite_glyph =
-          down_cast<GlyphTable::CompositeGlyph*>(glyph.p_);
-      int32_t num_glyphs = composite_glyph->NumGlyphs();
-      for (int32_t i = 0; i < num_glyphs; ++i) {
-        int32_t glyph_id = composite_glyph->GlyphIndex(i);
-        if (resolved_glyph_ids->find(GlyphId(glyph_id, -1))
-            == resolved_glyph_ids->end()) {
-          unresolved_glyph_ids->insert(glyph_id);
-        }
+    // Mark the glyph as resolved; glyph 0 already is.
+    if (glyph_id != 0)
+      resolved_ids.push_back(glyph_id);
+    // If it is composite, push all its unvisited components.
+    for (GlyphTable::GlyphView::ComponentIterator components =
+             GlyphTable::GlyphView(glyph).Components();
+         components.HasNext();) {
+      int32_t component_id = components.Next();
+      if (component_id <= num_glyphs && !visited[component_id]) {
+        visited[component_id] = true;
+        unresolved_glyph_ids.push_back(component_id);
       }
     }
   }
-  delete unresolved_glyph_ids;
+  std::sort(resolved_ids.begin(), resolved_ids.end());
+  resolved_glyph_ids->reserve(resolved_ids.size());
+  for (IntegerList::iterator it = resolved_ids.begin(), e = resolved_ids.end();
+       it != e; ++it) {
+    resolved_glyph_ids->push_back(GlyphId(*it, font_id_));
+  }
   return true;
 }
 }
@@ -18,17 +18,19 @@
 #define TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_FONT_INFO_H_
 
 #include <map>
-#include <set>
+#include <utility>
+#include <vector>
 
 #include "sfntly/font.h"
+#include "sfntly/port/arena.h"
 #include "sfntly/port/type.h"
 #include "sfntly/port/refcount.h"
 #include "sfntly/table/core/cmap_table.h"
 #include "sfntly/table/truetype/glyph_table.h"
 #include "sfntly/table/truetype/loca_table.h"
+#include "subtly/character_predicate.h"
 
 namespace subtly {
-class CharacterPredicate;
 
 typedef int32_t FontId;
 typedef std::map<FontId, sfntly::Ptr<sfntly::Font> > FontIdMap;
@@ -53,11 +55,26 @@ class GlyphId {
   FontId font_id_;
 };
 
-typedef std::map<int32_t, GlyphId> CharacterMap;
-typedef std::set<GlyphId> GlyphIdSet;
+// Built fresh for every subset as flat arrays, so that assembling the font
+// walks contiguous memory; their storage comes from the job's arena when one
+// is installed.
+// (character, glyph) pairs sorted by character, one pair per character.
+typedef std::vector<std::pair<int32_t, GlyphId>,
+                    sfntly::ArenaAllocator<std::pair<int32_t, GlyphId> > >
+    CharacterMap;
+// Glyph ids sorted by glyph id, one entry per glyph id.
+typedef std::vector<GlyphId, sfntly::ArenaAllocator<GlyphId> > GlyphIdSet;
+
+// Restores the order of a CharacterMap filled in any order. Of several pairs
+// for one character the first is kept, as std::map::insert would.
+void SortCharacterMap(CharacterMap* chars_to_glyph_ids);
+// Restores the order of a GlyphIdSet filled in any order, keeping the first
+// entry of each glyph id.
+void SortGlyphIdSet(GlyphIdSet* glyph_ids);
 
 // Font information used for FontAssembler in the construction of a new font.
-// Will make copies of character map, glyph id set and font id map.
+// Will make copies of character map, glyph id set and font id map unless
+// they are moved in.
 class FontInfo : public sfntly::RefCounted<FontInfo> {
  public:
   // Empty FontInfo object.
@@ -78,20 +95,26 @@ class FontInfo : public sfntly::RefCounted<FontInfo> {
   // Gets the table map of the font whose id is font_id
   virtual const sfntly::TableMap* GetTableMap(FontId);
 
-  CharacterMap* chars_to_glyph_ids() const { return chars_to_glyph_ids_; }
-  // Takes ownership of the chars_to_glyph_ids CharacterMap.
+  CharacterMap* chars_to_glyph_ids() { return &chars_to_glyph_ids_; }
+  // Copies the chars_to_glyph_ids CharacterMap.
   void set_chars_to_glyph_ids(CharacterMap* chars_to_glyph_ids);
-  GlyphIdSet* resolved_glyph_ids() const { return resolved_glyph_ids_; }
-  // Takes ownership of the glyph_ids GlyphIdSet.
+  // Takes over the contents of chars_to_glyph_ids without copying.
+  void set_chars_to_glyph_ids(CharacterMap&& chars_to_glyph_ids);
+  GlyphIdSet* resolved_glyph_ids() { return &resolved_glyph_ids_; }
+  // Copies the glyph_ids GlyphIdSet.
   void set_resolved_glyph_ids(GlyphIdSet* glyph_ids);
-  FontIdMap* fonts() const { return fonts_; }
-  // Takes ownership of the fonts FontIdMap.
+  // Takes over the contents of glyph_ids without copying.
+  void set_resolved_glyph_ids(GlyphIdSet&& glyph_ids);
+  FontIdMap* fonts() { return &fonts_; }
+  // Copies the fonts FontIdMap.
   void set_fonts(FontIdMap* fonts);
+  // Takes over the contents of fonts without copying.
+  void set_fonts(FontIdMap&& fonts);
 
  private:
-  CharacterMap* chars_to_glyph_ids_;
-  GlyphIdSet* resolved_glyph_ids_;
-  FontIdMap* fonts_;
+  CharacterMap chars_to_glyph_ids_;
+  GlyphIdSet resolved_glyph_ids_;
+  FontIdMap fonts_;
 };
 
 // FontSourcedInfoBuilder is used to create a FontInfo object from a Font
@@ -111,11 +134,24 @@ class FontSourcedInfoBuilder :
 
  protected:
   bool GetCharacterMap(CharacterMap* chars_to_glyph_ids);
+  // Appends every cmap character the predicate accepts. Predicate is any type
+  // callable as bool(int32_t); it is called directly rather than through
+  // CharacterPredicate's virtual operator(), so that e.g. a CodepointSet
+  // test inlines into the loop.
+  template <typename Predicate>
+  bool FilterCharacterMap(const Predicate& predicate,
+                          CharacterMap* chars_to_glyph_ids);
+  // Appends the character if the cmap has it.
+  void AddMappedCharacter(int32_t character, CharacterMap* chars_to_glyph_ids);
   bool ResolveCompositeGlyphs(CharacterMap* chars_to_glyph_ids,
                               GlyphIdSet* resolved_glyph_ids);
   void Initialize();
 
  private:
+  // Predicates listing more characters than this are tested against the
+  // cmap's characters rather than looked up one by one.
+  static const int64_t kMaxLookedUpCharacters;
+
   sfntly::Ptr<sfntly::Font> font_;
   FontId font_id_;
   CharacterPredicate* predicate_;
@@ -125,5 +161,39 @@ class FontSourcedInfoBuilder :
   sfntly::Ptr<sfntly::LocaTable> loca_table_;
   sfntly::Ptr<sfntly::GlyphTable> glyph_table_;
 };
+
+// Adapts an optional CharacterPredicate to FilterCharacterMap; no predicate
+// accepts every character.
+class PredicateRef {
+ public:
+  explicit PredicateRef(const CharacterPredicate* predicate)
+      : predicate_(predicate) {
+  }
+  bool operator()(int32_t character) const {
+    return !predicate_ || (*predicate_)(character);
+  }
+
+ private:
+  const CharacterPredicate* predicate_;
+};
+
+template <typename Predicate>
+bool FontSourcedInfoBuilder::FilterCharacterMap(
+    const Predicate& predicate, CharacterMap* chars_to_glyph_ids) {
+  sfntly::CMapTable::CMap::CharacterIterator* character_iterator =
+      cmap_->Iterator();
+  if (!character_iterator)
+    return false;
+  while (character_iterator->HasNext()) {
+    int32_t character = character_iterator->Next();
+    if (predicate(character)) {
+      chars_to_glyph_ids->push_back
+          (std::make_pair(character,
+                          GlyphId(cmap_->GlyphId(character), font_id_)));
+    }
+  }
+  delete character_iterator;
+  return true;
+}
 }
 #endif  // TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_FONT_INFO_H_
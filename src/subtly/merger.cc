@@ -70,12 +70,17 @@ CALLER_ATTACH FontInfo* Merger::MergeFontInfos() {
 #endif
       return NULL;
     }
+    // Characters and glyphs already merged from an earlier font win.
     font_info->chars_to_glyph_ids()->insert(
+        font_info->chars_to_glyph_ids()->end(),
         current_font_info->chars_to_glyph_ids()->begin(),
         current_font_info->chars_to_glyph_ids()->end());
+    SortCharacterMap(font_info->chars_to_glyph_ids());
     font_info->resolved_glyph_ids()->insert(
+        font_info->resolved_glyph_ids()->end(),
         current_font_info->resolved_glyph_ids()->begin(),
         current_font_info->resolved_glyph_ids()->end());
+    SortGlyphIdSet(font_info->resolved_glyph_ids());
 #if defined (SUBTLY_DEBUG)
     fprintf(stderr, "Counts: chars_to_glyph_ids: %d; resoved_glyph_ids: %d\n",
             font_info->chars_to_glyph_ids()->size(),
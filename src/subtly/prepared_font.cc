@@ -0,0 +1,314 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "subtly/prepared_font.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "sfntly/tag.h"
+#include "sfntly/table/core/cmap_table.h"
+#include "sfntly/table/truetype/loca_table.h"
+
+namespace subtly {
+using namespace sfntly;
+
+namespace {
+
+bool CharacterLess(const std::pair<int32_t, int32_t>& a,
+                   const std::pair<int32_t, int32_t>& b) {
+  return a.first < b.first;
+}
+
+bool SameCharacter(const std::pair<int32_t, int32_t>& a,
+                   const std::pair<int32_t, int32_t>& b) {
+  return a.first == b.first;
+}
+
+}  // namespace
+
+/******************************************************************************
+ * PreparedFont class
+ ******************************************************************************/
+CALLER_ATTACH PreparedFont* PreparedFont::Prepare(Font* font) {
+  if (!font)
+    return NULL;
+  Ptr<PreparedFont> prepared_font = new PreparedFont(font);
+  if (!prepared_font->Initialize())
+    return NULL;
+  return prepared_font.Detach();
+}
+
+PreparedFont::PreparedFont(Font* font)
+    : font_(font),
+      font_id_(0),
+      num_glyphs_(0),
+      post_version_(0) {
+}
+
+bool PreparedFont::Initialize() {
+  Ptr<CMapTable> cmap_table =
+      down_cast<CMapTable*>(font_->GetTable(Tag::cmap));
+  Ptr<LocaTable> loca_table = down_cast<LocaTable*>(font_->GetTable(Tag::loca));
+  Ptr<GlyphTable> glyph_table =
+      down_cast<GlyphTable*>(font_->GetTable(Tag::glyf));
+  post_table_ = down_cast<PostScriptTable*>(font_->GetTable(Tag::post));
+  if (!cmap_table || !loca_table || !glyph_table || !post_table_)
+    return false;
+
+  // We prefer Windows BMP format 4 cmaps, as FontSourcedInfoBuilder does.
+  Ptr<CMapTable::CMap> cmap;
+  cmap.Attach(cmap_table->GetCMap(CMapTable::WINDOWS_BMP));
+  if (!cmap)
+    return false;
+  CMapTable::CMap::CharacterIterator* character_iterator = cmap->Iterator();
+  if (!character_iterator)
+    return false;
+  while (character_iterator->HasNext()) {
+    int32_t character = character_iterator->Next();
+    character_map_.push_back(CharacterGlyph(character,
+                                            cmap->GlyphId(character)));
+  }
+  delete character_iterator;
+  // Keep the first mapping of a character, as inserting into a map would.
+  std::stable_sort(character_map_.begin(), character_map_.end(),
+                   CharacterLess);
+  character_map_.erase(std::unique(character_map_.begin(),
+                                   character_map_.end(), SameCharacter),
+                       character_map_.end());
+
+  // Without a usable maxp loca has no glyph count, and nothing below could be
+  // sized from it.
+  num_glyphs_ = loca_table->num_glyphs();
+  if (num_glyphs_ < 0)
+    return false;
+  glyf_data_ = glyph_table->ReadFontData();
+  glyf_span_ = glyf_data_->Span();
+  glyph_offsets_.resize(num_glyphs_ + 1, 0);
+  glyph_lengths_.resize(num_glyphs_ + 1, 0);
+  glyph_valid_.resize(num_glyphs_ + 1, false);
+  component_starts_.resize(num_glyphs_ + 2, 0);
+  for (int32_t glyph_id = 0; glyph_id <= num_glyphs_; ++glyph_id) {
+    component_starts_[glyph_id] = (int32_t)components_.size();
+    if (glyph_id < num_glyphs_) {
+      glyph_offsets_[glyph_id] = loca_table->GlyphOffset(glyph_id);
+      glyph_lengths_[glyph_id] = loca_table->GlyphLength(glyph_id);
+    }
+    FontDataSpan glyph = glyf_span_.Subspan(glyph_offsets_[glyph_id],
+                                            glyph_lengths_[glyph_id]);
+    if (!glyph.IsValid())
+      continue;
+    glyph_valid_[glyph_id] = true;
+    for (GlyphTable::GlyphView::ComponentIterator components =
+             GlyphTable::GlyphView(glyph).Components();
+         components.HasNext();) {
+      components_.push_back(components.Next());
+    }
+  }
+  component_starts_[num_glyphs_ + 1] = (int32_t)components_.size();
+
+  metrics_ = down_cast<HorizontalMetricsTable*>(font_->GetTable(Tag::hmtx));
+  if (metrics_)
+    metrics_->Metrics(&advance_widths_, &lsbs_);
+
+  post_version_ = post_table_->Version();
+  if (post_version_ == PostScriptTable::VERSION_1 ||
+      post_version_ == PostScriptTable::VERSION_2) {
+    int32_t num_names = post_table_->NumberOfGlyphs();
+    glyph_names_.reserve(std::max<int32_t>(num_names, 0));
+    for (int32_t glyph_id = 0; glyph_id < num_names; ++glyph_id) {
+      glyph_names_.push_back(post_table_->GlyphName(glyph_id));
+    }
+  }
+  return true;
+}
+
+CALLER_ATTACH FontInfo*
+PreparedFont::GetFontInfo(const IntegerSet* characters) {
+  if (!characters)
+    return NULL;
+  CharacterMap chars_to_glyph_ids;
+  IntegerList unresolved_glyph_ids;
+  for (IntegerSet::const_iterator it = characters->begin(),
+           e = characters->end(); it != e; ++it) {
+    AddCharacter(*it, &chars_to_glyph_ids, &unresolved_glyph_ids);
+  }
+  return NewFontInfo(&chars_to_glyph_ids, &unresolved_glyph_ids);
+}
+
+CALLER_ATTACH FontInfo*
+PreparedFont::GetFontInfo(const CharacterPredicate* predicate) {
+  if (!predicate)
+    return NULL;
+  CharacterMap chars_to_glyph_ids;
+  IntegerList unresolved_glyph_ids;
+  const CodepointSet* codepoint_set = predicate->codepoint_set();
+  int64_t character_count = predicate->CharacterCount();
+  if (character_count >= 0 &&
+      character_count <= (int64_t)character_map_.size()) {
+    if (codepoint_set) {
+      codepoint_set->ForEach([&](int32_t character) {
+        AddCharacter(character, &chars_to_glyph_ids, &unresolved_glyph_ids);
+      });
+    } else {
+      IntegerList characters;
+      predicate->GetCharacters(&characters);
+      for (IntegerList::iterator it = characters.begin(),
+               e = characters.end(); it != e; ++it) {
+        AddCharacter(*it, &chars_to_glyph_ids, &unresolved_glyph_ids);
+      }
+    }
+  } else if (codepoint_set) {
+    FilterCharacterMap(*codepoint_set, &chars_to_glyph_ids,
+                       &unresolved_glyph_ids);
+  } else {
+    FilterCharacterMap(PredicateRef(predicate), &chars_to_glyph_ids,
+                       &unresolved_glyph_ids);
+  }
+  return NewFontInfo(&chars_to_glyph_ids, &unresolved_glyph_ids);
+}
+
+template <typename Predicate>
+void PreparedFont::FilterCharacterMap(const Predicate& predicate,
+                                      CharacterMap* chars_to_glyph_ids,
+                                      IntegerList* unresolved_glyph_ids) const {
+  for (std::vector<CharacterGlyph>::const_iterator it = character_map_.begin(),
+           e = character_map_.end(); it != e; ++it) {
+    if (predicate(it->first)) {
+      chars_to_glyph_ids->push_back(
+          std::make_pair(it->first, subtly::GlyphId(it->second, font_id_)));
+      unresolved_glyph_ids->push_back(it->second);
+    }
+  }
+}
+
+void PreparedFont::AddCharacter(int32_t character,
+                                CharacterMap* chars_to_glyph_ids,
+                                IntegerList* unresolved_glyph_ids) const {
+  std::vector<CharacterGlyph>::const_iterator mapping =
+      std::lower_bound(character_map_.begin(), character_map_.end(),
+                       CharacterGlyph(character, 0), CharacterLess);
+  if (mapping == character_map_.end() || mapping->first != character)
+    return;
+  chars_to_glyph_ids->push_back(
+      std::make_pair(character, subtly::GlyphId(mapping->second, font_id_)));
+  unresolved_glyph_ids->push_back(mapping->second);
+}
+
+CALLER_ATTACH FontInfo*
+PreparedFont::NewFontInfo(CharacterMap* chars_to_glyph_ids,
+                          IntegerList* unresolved_glyph_ids) {
+  // Only a predicate's own list can come in another order.
+  SortCharacterMap(chars_to_glyph_ids);
+  GlyphIdSet resolved_glyph_ids;
+  ResolveCompositeGlyphs(unresolved_glyph_ids, &resolved_glyph_ids);
+
+  Ptr<FontInfo> font_info = new FontInfo;
+  font_info->set_chars_to_glyph_ids(std::move(*chars_to_glyph_ids));
+  font_info->set_resolved_glyph_ids(std::move(resolved_glyph_ids));
+  FontIdMap font_id_map;
+  font_id_map.insert(std::make_pair(font_id_, font_));
+  font_info->set_fonts(std::move(font_id_map));
+  return font_info.Detach();
+}
+
+int32_t PreparedFont::GlyphId(int32_t character) const {
+  std::vector<CharacterGlyph>::const_iterator it =
+      std::lower_bound(character_map_.begin(), character_map_.end(),
+                       CharacterGlyph(character, 0), CharacterLess);
+  if (it == character_map_.end() || it->first != character)
+    return -1;
+  return it->second;
+}
+
+int32_t PreparedFont::GlyphOffset(int32_t glyph_id) const {
+  if (glyph_id < 0 || glyph_id >= num_glyphs_)
+    return 0;
+  return glyph_offsets_[glyph_id];
+}
+
+int32_t PreparedFont::GlyphLength(int32_t glyph_id) const {
+  if (glyph_id < 0 || glyph_id >= num_glyphs_)
+    return 0;
+  return glyph_lengths_[glyph_id];
+}
+
+FontDataSpan PreparedFont::GlyphData(int32_t glyph_id) const {
+  return glyf_span_.Subspan(GlyphOffset(glyph_id), GlyphLength(glyph_id));
+}
+
+int32_t PreparedFont::AdvanceWidth(int32_t glyph_id) {
+  if (glyph_id >= 0 && glyph_id < (int32_t)advance_widths_.size())
+    return advance_widths_[glyph_id];
+  return metrics_ ? metrics_->AdvanceWidth(glyph_id) : 0;
+}
+
+int32_t PreparedFont::LeftSideBearing(int32_t glyph_id) {
+  if (glyph_id >= 0 && glyph_id < (int32_t)lsbs_.size())
+    return lsbs_[glyph_id];
+  return metrics_ ? metrics_->LeftSideBearing(glyph_id) : 0;
+}
+
+std::string PreparedFont::GlyphName(int32_t glyph_id) {
+  if (glyph_id >= 0 && glyph_id < (int32_t)glyph_names_.size())
+    return glyph_names_[glyph_id];
+  return post_table_->GlyphName(glyph_id);
+}
+
+void PreparedFont::ResolveCompositeGlyphs(IntegerList* unresolved_glyph_ids,
+                                          GlyphIdSet* resolved_glyph_ids) {
+  // The same walk as FontSourcedInfoBuilder::ResolveCompositeGlyphs, over the
+  // component lists decoded in Initialize().
+  if (num_glyphs_ <= 0) {
+    resolved_glyph_ids->push_back(subtly::GlyphId(0, font_id_));
+    return;
+  }
+  // |visited| has a bit per glyph id so that no glyph is walked twice.
+  std::vector<bool> visited(num_glyphs_ + 1, false);
+  // Drop repeated ids and ids outside the font; the rest is the walk's stack.
+  size_t num_unresolved = 0;
+  for (size_t i = 0; i < unresolved_glyph_ids->size(); ++i) {
+    int32_t glyph_id = (*unresolved_glyph_ids)[i];
+    if (glyph_id >= 0 && glyph_id <= num_glyphs_ && !visited[glyph_id]) {
+      visited[glyph_id] = true;
+      (*unresolved_glyph_ids)[num_unresolved++] = glyph_id;
+    }
+  }
+  unresolved_glyph_ids->resize(num_unresolved);
+  visited[0] = true;
+  IntegerList resolved_ids(1, 0);
+  while (!unresolved_glyph_ids->empty()) {
+    int32_t glyph_id = unresolved_glyph_ids->back();
+    unresolved_glyph_ids->pop_back();
+    if (!glyph_valid_[glyph_id])
+      continue;
+    if (glyph_id != 0)
+      resolved_ids.push_back(glyph_id);
+    for (int32_t i = component_starts_[glyph_id],
+             end = component_starts_[glyph_id + 1]; i < end; ++i) {
+      int32_t component_id = components_[i];
+      if (component_id <= num_glyphs_ && !visited[component_id]) {
+        visited[component_id] = true;
+        unresolved_glyph_ids->push_back(component_id);
+      }
+    }
+  }
+  std::sort(resolved_ids.begin(), resolved_ids.end());
+  resolved_glyph_ids->reserve(resolved_ids.size());
+  for (IntegerList::iterator it = resolved_ids.begin(), e = resolved_ids.end();
+       it != e; ++it) {
+    resolved_glyph_ids->push_back(subtly::GlyphId(*it, font_id_));
+  }
+}
+}
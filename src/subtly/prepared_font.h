@@ -0,0 +1,145 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_PREPARED_FONT_H_
+#define TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_PREPARED_FONT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sfntly/data/font_data_span.h"
+#include "sfntly/font.h"
+#include "sfntly/port/refcount.h"
+#include "sfntly/port/type.h"
+#include "sfntly/table/core/horizontal_metrics_table.h"
+#include "sfntly/table/core/post_script_table.h"
+#include "sfntly/table/truetype/glyph_table.h"
+#include "subtly/character_predicate.h"
+#include "subtly/font_info.h"
+
+namespace subtly {
+// The parts of a font that subsetting reads, decoded once so that any number
+// of subsets can be cut from the font without decoding it again: the Windows
+// BMP cmap, the loca offsets, the composite glyph components, the horizontal
+// metrics and the PostScript glyph names. The cost of a subset then depends
+// on the characters requested, not on the size of the font.
+// Subsets share the prepared font's table data instead of copying it. Each
+// shared table builder wraps the data in its own slice (see
+// Table::Builder::GetSharedBuilder()), and checksums cached on the data are
+// atomic, so subsetting leaves the prepared font and its data untouched. One
+// PreparedFont can then be shared between threads as long as it was prepared
+// outside any Arena and thread-confined RefCountPolicyScope.
+class PreparedFont : public sfntly::RefCounted<PreparedFont> {
+ public:
+  virtual ~PreparedFont() {}
+
+  // Decodes the font. The font is kept alive by the prepared font.
+  // @return NULL if the font has no Windows BMP cmap, loca, glyf or post
+  //         table, or loca has no glyph count
+  static CALLER_ATTACH PreparedFont* Prepare(sfntly::Font* font);
+
+  // Builds the FontInfo for a subset of the given characters: the characters
+  // the cmap maps, and every glyph they need including composite components.
+  // Characters missing from the cmap are ignored.
+  CALLER_ATTACH FontInfo* GetFontInfo(const sfntly::IntegerSet* characters);
+  // As above, for the characters the predicate accepts. A predicate that can
+  // list its characters is answered by looking them up, one that cannot by
+  // testing every character of the cmap.
+  CALLER_ATTACH FontInfo* GetFontInfo(const CharacterPredicate* predicate);
+
+  sfntly::Font* font() { return font_; }
+  FontId font_id() const { return font_id_; }
+  int32_t num_glyphs() const { return num_glyphs_; }
+
+  // @return the glyph the cmap maps character to; -1 if it is not mapped
+  int32_t GlyphId(int32_t character) const;
+
+  // The loca entries of a glyph; 0 for glyph ids outside the font, as
+  // LocaTable returns.
+  int32_t GlyphOffset(int32_t glyph_id) const;
+  int32_t GlyphLength(int32_t glyph_id) const;
+
+  // @return the glyph's data in the glyf table; an invalid span if the loca
+  //         entries point outside the table
+  sfntly::FontDataSpan GlyphData(int32_t glyph_id) const;
+
+  // The horizontal metrics of a glyph, from the decoded hmtx arrays where
+  // they cover the glyph and from the hmtx table otherwise.
+  bool has_metrics() const { return metrics_ != NULL; }
+  int32_t AdvanceWidth(int32_t glyph_id);
+  int32_t LeftSideBearing(int32_t glyph_id);
+
+  // The post table and its glyph names, decoded for versions 1 and 2.
+  sfntly::PostScriptTable* post_table() { return post_table_; }
+  int32_t post_version() const { return post_version_; }
+  std::string GlyphName(int32_t glyph_id);
+
+ private:
+  typedef std::pair<int32_t, int32_t> CharacterGlyph;
+
+  explicit PreparedFont(sfntly::Font* font);
+  bool Initialize();
+
+  // Maps every cmap character the predicate accepts, as AddCharacter does.
+  // Predicate is any type callable as bool(int32_t).
+  template <typename Predicate>
+  void FilterCharacterMap(const Predicate& predicate,
+                          CharacterMap* chars_to_glyph_ids,
+                          sfntly::IntegerList* unresolved_glyph_ids) const;
+  // Maps the character, if the cmap has it, and queues its glyph for
+  // resolution.
+  void AddCharacter(int32_t character, CharacterMap* chars_to_glyph_ids,
+                    sfntly::IntegerList* unresolved_glyph_ids) const;
+  // Resolves the glyphs and builds the FontInfo from the results.
+  CALLER_ATTACH FontInfo* NewFontInfo(CharacterMap* chars_to_glyph_ids,
+                                      sfntly::IntegerList* unresolved_glyph_ids);
+
+  // Adds the glyphs reachable from the glyph ids in unresolved_glyph_ids,
+  // and glyph 0, to resolved_glyph_ids. unresolved_glyph_ids may repeat ids
+  // and is used up as the walk's stack.
+  void ResolveCompositeGlyphs(sfntly::IntegerList* unresolved_glyph_ids,
+                              GlyphIdSet* resolved_glyph_ids);
+
+  sfntly::Ptr<sfntly::Font> font_;
+  FontId font_id_;
+  int32_t num_glyphs_;
+
+  // (character, glyph id) pairs sorted by character.
+  std::vector<CharacterGlyph> character_map_;
+
+  // Indexed by glyph id in [0, num_glyphs]; the last entry stands for the one
+  // past the end glyph id that LocaTable still answers for.
+  std::vector<int32_t> glyph_offsets_;
+  std::vector<int32_t> glyph_lengths_;
+  std::vector<bool> glyph_valid_;
+  // Components of glyph g are components_[component_starts_[g]] up to
+  // components_[component_starts_[g + 1]].
+  std::vector<int32_t> component_starts_;
+  std::vector<int32_t> components_;
+
+  sfntly::ReadableFontDataPtr glyf_data_;
+  sfntly::FontDataSpan glyf_span_;
+
+  sfntly::HorizontalMetricsTablePtr metrics_;
+  std::vector<int32_t> advance_widths_;
+  std::vector<int32_t> lsbs_;
+
+  sfntly::Ptr<sfntly::PostScriptTable> post_table_;
+  int32_t post_version_;
+  std::vector<std::string> glyph_names_;
+};
+}
+
+#endif  // TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_PREPARED_FONT_H_
@@ -34,12 +34,16 @@ using namespace sfntly;
  ******************************************************************************/
 Subsetter::Subsetter(Font* font, CharacterPredicate* predicate)
     : font_(font),
-      predicate_(predicate) {
+      predicate_(predicate),
+      retain_glyph_ids_(false) {
 }
 
 Subsetter::Subsetter(const char* font_path, CharacterPredicate* predicate)
-    : predicate_(predicate) {
-  font_.Attach(LoadFont(font_path));
+    : predicate_(predicate),
+      retain_glyph_ids_(false) {
+  IntegerSet table_blacklist;
+  GetTableBlacklist(&table_blacklist);
+  font_.Attach(LoadFont(font_path, &table_blacklist));
 }
 
 CALLER_ATTACH Font* Subsetter::Subset() {
@@ -55,7 +59,68 @@ CALLER_ATTACH Font* Subsetter::Subset() {
 #endif
     return NULL;
   }
-  IntegerSet* table_blacklist = new IntegerSet;
+  IntegerSet table_blacklist;
+  GetTableBlacklist(&table_blacklist);
+  Ptr<FontAssembler> font_assembler = new FontAssembler(font_info,
+                                                        &table_blacklist);
+  font_assembler->set_retain_glyph_ids(retain_glyph_ids_);
+  Ptr<Font> font_subset;
+  font_subset.Attach(font_assembler->Assemble());
+  return font_subset.Detach();
+}
+
+namespace {
+
+// Assembles the subset a prepared font produced the font info for.
+CALLER_ATTACH Font* AssembleSubset(PreparedFont* prepared_font,
+                                   FontInfo* font_info,
+                                   bool retain_glyph_ids) {
+  if (!font_info) {
+#if defined (SUBTLY_DEBUG)
+    fprintf(stderr,
+            "Couldn't create font info. No subset will be generated.\n");
+#endif
+    return NULL;
+  }
+  IntegerSet table_blacklist;
+  Subsetter::GetTableBlacklist(&table_blacklist);
+  Ptr<FontAssembler> font_assembler = new FontAssembler(font_info,
+                                                        &table_blacklist,
+                                                        prepared_font);
+  font_assembler->set_retain_glyph_ids(retain_glyph_ids);
+  Ptr<Font> font_subset;
+  font_subset.Attach(font_assembler->Assemble());
+  return font_subset.Detach();
+}
+
+}  // namespace
+
+CALLER_ATTACH Font* Subset(PreparedFont* prepared_font,
+                           const IntegerSet* characters) {
+  if (!prepared_font)
+    return NULL;
+  Ptr<FontInfo> font_info;
+  font_info.Attach(prepared_font->GetFontInfo(characters));
+  return AssembleSubset(prepared_font, font_info, false);
+}
+
+CALLER_ATTACH Font* Subset(PreparedFont* prepared_font,
+                           const CharacterPredicate* predicate) {
+  return Subset(prepared_font, predicate, false);
+}
+
+CALLER_ATTACH Font* Subset(PreparedFont* prepared_font,
+                           const CharacterPredicate* predicate,
+                           bool retain_glyph_ids) {
+  if (!prepared_font)
+    return NULL;
+  Ptr<FontInfo> font_info;
+  font_info.Attach(prepared_font->GetFontInfo(predicate));
+  return AssembleSubset(prepared_font, font_info, retain_glyph_ids);
+}
+
+void Subsetter::GetTableBlacklist(IntegerSet* table_blacklist) {
+  assert(table_blacklist);
   table_blacklist->insert(Tag::DSIG);
   table_blacklist->insert(Tag::GDEF);
   table_blacklist->insert(Tag::GPOS);
@@ -69,12 +134,5 @@ CALLER_ATTACH Font* Subsetter::Subset() {
   table_blacklist->insert(Tag::morx);
   table_blacklist->insert(GenerateTag('m', 'o', 'r', 't'));
   //table_blacklist->insert(Tag::post);//移除此表浏览器可能解析不了
-
-  Ptr<FontAssembler> font_assembler = new FontAssembler(font_info,
-                                                        table_blacklist);
-  Ptr<Font> font_subset;
-  font_subset.Attach(font_assembler->Assemble());
-  delete table_blacklist;
-  return font_subset.Detach();
 }
 }
@@ -20,6 +20,7 @@
 #include "sfntly/font.h"
 // Cannot remove this header due to Ptr<T> instantiation issue
 #include "subtly/character_predicate.h"
+#include "subtly/prepared_font.h"
 
 namespace subtly {
 // Subsets a given font using a character predicate.
@@ -32,10 +33,34 @@ class Subsetter : public sfntly::RefCounted<Subsetter> {
   // Performs subsetting returning the subsetted font.
   virtual CALLER_ATTACH sfntly::Font* Subset();
 
+  // Whether the subset keeps the original glyph ids; see
+  // FontAssembler::set_retain_glyph_ids.
+  bool retain_glyph_ids() const { return retain_glyph_ids_; }
+  void set_retain_glyph_ids(bool retain_glyph_ids) {
+    retain_glyph_ids_ = retain_glyph_ids;
+  }
+
+  // Gets the tables that are dropped from every subset. Loading a font with
+  // these tables filtered out saves reading them at all.
+  static void GetTableBlacklist(sfntly::IntegerSet* table_blacklist);
+
  protected:
   sfntly::Ptr<sfntly::Font> font_;
   sfntly::Ptr<CharacterPredicate> predicate_;
+  bool retain_glyph_ids_;
 };
+
+// Subsets a prepared font to the given characters. The subset leaves the
+// prepared font untouched, so it can be reused for any number of subsets; see
+// PreparedFont for sharing one between threads.
+CALLER_ATTACH sfntly::Font* Subset(PreparedFont* prepared_font,
+                                   const sfntly::IntegerSet* characters);
+CALLER_ATTACH sfntly::Font* Subset(PreparedFont* prepared_font,
+                                   const CharacterPredicate* predicate);
+// As above, keeping the original glyph ids if retain_glyph_ids is set.
+CALLER_ATTACH sfntly::Font* Subset(PreparedFont* prepared_font,
+                                   const CharacterPredicate* predicate,
+                                   bool retain_glyph_ids);
 }
 
 #endif  // TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_SUBSETTER_H_
@@ -15,25 +15,64 @@
  */
 
 #include "subtly/utils.h"
+
+#include <string>
+
 #if !defined WIN32
+#include <errno.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #endif
 #include "sfntly/data/growable_memory_byte_array.h"
+#include "sfntly/data/mapped_byte_array.h"
 #include "sfntly/data/memory_byte_array.h"
 #include "sfntly/font.h"
 #include "sfntly/font_factory.h"
-#include "sfntly/port/file_input_stream.h"
-#include "sfntly/port/memory_output_stream.h"
+#include "sfntly/port/file_output_stream.h"
+#include "sfntly/port/random_access_file_input_stream.h"
 
 namespace subtly {
 using namespace sfntly;
 
+#if !defined WIN32
+namespace {
+
+// Creates the directory and any missing parents, like mkdir -p.
+bool MakeDirectories(const std::string& dir) {
+  if (dir.empty() || access(dir.c_str(), F_OK) == 0)
+    return true;
+  std::string::size_type slash = dir.find_last_of('/');
+  if (slash != std::string::npos && slash > 0 &&
+      !MakeDirectories(dir.substr(0, slash))) {
+    return false;
+  }
+  // Another thread may create it first.
+  return mkdir(dir.c_str(), 0775) == 0 || errno == EEXIST;
+}
+
+}  // namespace
+#endif
+
 CALLER_ATTACH Font* LoadFont(const char* font_path) {
   Ptr<FontFactory> font_factory;
   font_factory.Attach(FontFactory::GetInstance());
   FontArray fonts;
   LoadFonts(font_path, font_factory, &fonts);
+  if (fonts.empty())
+    return NULL;
+  return fonts[0].Detach();
+}
+
+CALLER_ATTACH Font* LoadFont(const char* font_path,
+                             const IntegerSet* excluded_tables) {
+  Ptr<FontFactory> font_factory;
+  font_factory.Attach(FontFactory::GetInstance());
+  if (excluded_tables)
+    font_factory->SetTableFilter(*excluded_tables, true);
+  FontArray fonts;
+  LoadFonts(font_path, font_factory, &fonts);
+  if (fonts.empty())
+    return NULL;
   return fonts[0].Detach();
 }
 
@@ -42,11 +81,21 @@ CALLER_ATTACH Font::Builder* LoadFontBuilder(const char* font_path) {
   font_factory.Attach(FontFactory::GetInstance());
   FontBuilderArray builders;
   LoadFontBuilders(font_path, font_factory, &builders);
+  if (builders.empty())
+    return NULL;
   return builders[0].Detach();
 }
 
 void LoadFonts(const char* font_path, FontFactory* factory, FontArray* fonts) {
-  FileInputStream input_stream;
+  // Map the file so that table data is sliced out of the page cache instead
+  // of being copied; fall back to reading the file where mapping fails.
+  MappedByteArrayPtr mapped;
+  mapped.Attach(MappedByteArray::Map(font_path, MappedAccessHint::kRandom));
+  if (mapped) {
+    factory->LoadFonts(mapped, fonts);
+    return;
+  }
+  RandomAccessFileInputStream input_stream;
   input_stream.Open(font_path);
   factory->LoadFonts(&input_stream, fonts);
   input_stream.Close();
@@ -55,7 +104,7 @@ void LoadFonts(const char* font_path, FontFactory* factory, FontArray* fonts) {
 void LoadFontBuilders(const char* font_path,
                       FontFactory* factory,
                       FontBuilderArray* builders) {
-  FileInputStream input_stream;
+  RandomAccessFileInputStream input_stream;
   input_stream.Open(font_path);
   factory->LoadFontsForBuilding(&input_stream, builders);
   input_stream.Close();
@@ -72,31 +121,38 @@ bool SerializeFont(const char* font_path, Font* font) {
 bool SerializeFont(const char* font_path, FontFactory* factory, Font* font) {
   if (!font_path || !factory || !font)
     return false;
-  // Serializing the font to a stream.
-  MemoryOutputStream output_stream;
-  factory->SerializeFont(font, &output_stream);
-  // Serializing the stream to a file.
-  FILE* output_file = NULL;
-#if defined WIN32
-  fopen_s(&output_file, font_path, "wb");
-#else
+#if !defined WIN32
   std::string fontPath(font_path);
-  std::string dir = fontPath.substr(0, fontPath.find_last_of('/'));
+  std::string::size_type slash = fontPath.find_last_of('/');
   //判断目录是否存在
-  if (access(dir.c_str(), F_OK) == -1) {
-    if (mkdir(dir.c_str(), 0775) == -1) {
-      return false;
-    }
-  }
-  output_file = fopen(font_path, "wb");
+  if (slash != std::string::npos && !MakeDirectories(fontPath.substr(0, slash)))
+    return false;
 #endif
-  if (output_file == reinterpret_cast<FILE*>(NULL))
+  // Serializing the font straight to the file.
+  FileOutputStream output_stream;
+  if (!output_stream.Open(font_path))
     return false;
-  for (size_t i = 0; i < output_stream.Size(); ++i) {
-    fwrite(&(output_stream.Get()[i]), 1, 1, output_file);
-  }
-  fflush(output_file);
-  fclose(output_file);
-  return true;
+  factory->SerializeFont(font, &output_stream);
+  output_stream.Close();
+  return !output_stream.error();
+}
+
+bool SerializeFontToDescriptor(int fd, FontFactory* factory, Font* font) {
+  if (fd < 0 || !factory || !font)
+    return false;
+  FileOutputStream output_stream;
+  if (!output_stream.Attach(fd))
+    return false;
+  factory->SerializeFont(font, &output_stream);
+  output_stream.Flush();
+  return !output_stream.error();
+}
+bool SerializeFontToBuffer(std::vector<uint8_t>* output,
+                           FontFactory* factory,
+                           Font* font,
+                           TaskRunner* task_runner) {
+  if (!output || !factory || !font)
+    return false;
+  return factory->SerializeFont(font, output, task_runner);
 }
 };
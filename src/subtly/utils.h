@@ -21,7 +21,15 @@
 #include "sfntly/font_factory.h"
 
 namespace subtly {
+// Loads the first font in the file; NULL if the file holds no font.
 CALLER_ATTACH sfntly::Font* LoadFont(const char* font_path);
+// Loads the font without reading the tables listed in excluded_tables; their
+// records are kept in the font's unloaded_table_headers(). NULL if the file
+// holds no font.
+CALLER_ATTACH sfntly::Font* LoadFont(const char* font_path,
+                                     const sfntly::IntegerSet* excluded_tables);
+// Loads a builder for the first font in the file; NULL if the file holds no
+// font.
 CALLER_ATTACH sfntly::Font::Builder* LoadFontBuilder(const char* font_path);
 
 void LoadFonts(const char* font_path, sfntly::FontFactory* factory,
@@ -33,6 +41,16 @@ void LoadFontBuilders(const char* font_path,
 bool SerializeFont(const char* font_path, sfntly::Font* font);
 bool SerializeFont(const char* font_path, sfntly::FontFactory* factory,
                    sfntly::Font* font);
+// Serializes the font to an already open descriptor such as stdout or a pipe.
+// The descriptor is left open.
+bool SerializeFontToDescriptor(int fd, sfntly::FontFactory* factory,
+                               sfntly::Font* font);
+// Serializes the font into a buffer allocated once at its exact final size.
+// The task runner, if not NULL, may help copy the tables.
+bool SerializeFontToBuffer(std::vector<uint8_t>* output,
+                           sfntly::FontFactory* factory,
+                           sfntly::Font* font,
+                           sfntly::TaskRunner* task_runner);
 }
 
 #endif  // TYPOGRAPHY_FONT_SFNTLY_SRC_SAMPLE_SUBTLY_UTILS_H_